@@ -0,0 +1,203 @@
+#ifndef SUDOKU_COUNTERS_H
+#define SUDOKU_COUNTERS_H
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+
+//NOTE: Hardware performance counters
+// Counts the events of the calling thread with perf_event_open, in user
+// space only. The events are opened as one group, so they are read together
+// by a single system call. The ones the machine or the permissions (see
+// /proc/sys/kernel/perf_event_paranoid) do not allow are left out, and the
+// counters are not available at all if none of them could be opened.
+class Counters
+{
+public:
+	enum Event {
+		CYCLES,
+		INSTRUCTIONS,
+		BRANCH_MISSES,
+		L1D_MISSES,
+		LLC_MISSES,
+		EVENTS,
+	};
+
+	// Counts of the events, the ones missing from the mask were not counted
+	struct Sample
+	{
+		uint64_t  values[EVENTS];
+		unsigned  mask;
+
+		inline Sample() : mask(0) {
+			memset( values, 0, sizeof(values) );
+		}
+
+		inline bool  has( const Event e ) const {
+			return mask & (1 << e);
+		}
+
+		Sample&  operator+= ( const Sample &o )
+		{
+			for( int e = 0; e != EVENTS; ++e )
+				values[e] += o.values[e];
+			mask |= o.mask;
+			return *this;
+		}
+	};
+
+	inline Counters() : _leader(-1), _members(0), _mask(0)  {}
+
+	//NOTE: the events belong to the thread which opened them, so a copy
+	// starts closed
+	inline Counters( const Counters& ) : _leader(-1), _members(0), _mask(0)  {}
+
+	inline Counters&  operator= ( const Counters& ) {
+		return *this;
+	}
+
+	inline ~Counters() {
+		close();
+	}
+
+	// Opens the events for the calling thread, returns whether any of them
+	// could be opened (if not, error() tells why)
+	bool  open()
+	{
+		close();
+		_error.clear();
+
+		for( int e = 0; e != EVENTS; ++e )
+		{
+			perf_event_attr  attr;
+			memset( &attr, 0, sizeof(attr) );
+			attr.size = sizeof(attr);
+			attr.type = (e == L1D_MISSES) ? PERF_TYPE_HW_CACHE : PERF_TYPE_HARDWARE;
+			attr.config = config( (Event) e );
+			attr.disabled = _leader == -1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+
+			const int  fd = syscall( __NR_perf_event_open, &attr, 0, -1, _leader, 0 );
+			if( fd == -1 )
+			{
+				if( _leader == -1 && _error.empty() )
+					_error = strerror(errno);
+				continue;
+			}
+
+			if( _leader == -1 )
+				_leader = fd;
+			_fds[_members] = fd;
+			_order[_members++] = (Event) e;
+			_mask |= 1 << e;
+		}
+
+		if( _leader == -1 )
+			return false;
+
+		ioctl( _leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+		return true;
+	}
+
+	void  close()
+	{
+		for( int i = 0; i != _members; ++i )
+			::close( _fds[i] );
+
+		_leader = -1;
+		_members = 0;
+		_mask = 0;
+	}
+
+	inline bool  available() const {
+		return _leader != -1;
+	}
+
+	inline const std::string&  error() const {
+		return _error;
+	}
+
+	// Starts and stops counting a measured piece of code
+	inline void  start() {
+		read(_start);
+	}
+
+	inline void  stop()
+	{
+		Sample  now;
+		read(now);
+
+		for( int e = 0; e != EVENTS; ++e )
+			_last.values[e] = now.values[e] - _start.values[e];
+		_last.mask = now.mask;
+	}
+
+	// The counts between the last start and stop
+	inline const Sample&  last() const {
+		return _last;
+	}
+
+	static const char*  name( const Event e )
+	{
+		static const char  *names[EVENTS] = { "Cycles", "Instructions", "Branch misses", "L1D misses", "LLC misses" };
+		return names[e];
+	}
+
+private:
+	int  _leader;
+	int  _fds[EVENTS];
+	Event  _order[EVENTS];
+	int  _members;
+	unsigned  _mask;
+	std::string  _error;
+
+	Sample  _start;
+	Sample  _last;
+
+	static uint64_t  config( const Event e )
+	{
+		switch( e )
+		{
+		case CYCLES:
+			return PERF_COUNT_HW_CPU_CYCLES;
+
+		case INSTRUCTIONS:
+			return PERF_COUNT_HW_INSTRUCTIONS;
+
+		case BRANCH_MISSES:
+			return PERF_COUNT_HW_BRANCH_MISSES;
+
+		case L1D_MISSES:
+			return PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+		default:
+			return PERF_COUNT_HW_CACHE_MISSES;
+		}
+	}
+
+	// The group is read as the number of members, then their counts in the
+	// order they were opened
+	void  read( Sample &s ) const
+	{
+		s.mask = 0;
+		if( _leader == -1 )
+			return;
+
+		uint64_t  buffer[1 + EVENTS];
+		if( ::read( _leader, buffer, sizeof(buffer) ) < (ssize_t) sizeof(uint64_t) )
+			return;
+
+		for( uint64_t i = 0; i != buffer[0] && i != (uint64_t) _members; ++i )
+			s.values[ _order[i] ] = buffer[1 + i];
+		s.mask = _mask;
+	}
+};
+
+#endif
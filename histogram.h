@@ -0,0 +1,154 @@
+#ifndef SUDOKU_HISTOGRAM_H
+#define SUDOKU_HISTOGRAM_H
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+
+
+//NOTE: Log-bucketed histogram
+// Like HdrHistogram: every power of two range of values is split into
+// SUB_BUCKETS equal buckets, so a value is kept with a relative error below
+// 1/SUB_BUCKETS whatever its magnitude, and the values below SUB_BUCKETS are
+// exact. The count, total, min and max are exact. Histograms merge by adding
+// their buckets, so the ones of the workers, or of separate runs, combine
+// into the histogram of all their values.
+class Histogram
+{
+public:
+	enum {
+		PRECISION = 7,
+		SUB_BUCKETS = 1 << PRECISION,
+		MAX_EXPONENT = 48, // the values from 2^48 on share the top bucket
+		BUCKETS = (MAX_EXPONENT - PRECISION + 1) * SUB_BUCKETS,
+	};
+
+	inline Histogram() : _buckets(BUCKETS), _count(0), _total(0), _min(~(uint64_t) 0), _max(0)  {}
+
+	inline void  record( const uint64_t v )
+	{
+		++_buckets[ bucket(v) ];
+		++_count;
+		_total += v;
+		if( v < _min )
+			_min = v;
+		if( _max < v )
+			_max = v;
+	}
+
+	Histogram&  operator+= ( const Histogram &o )
+	{
+		for( int i = 0; i != BUCKETS; ++i )
+			_buckets[i] += o._buckets[i];
+		_count += o._count;
+		_total += o._total;
+		if( o._min < _min )
+			_min = o._min;
+		if( _max < o._max )
+			_max = o._max;
+		return *this;
+	}
+
+	inline uint64_t  count() const {
+		return _count;
+	}
+
+	inline uint64_t  total() const {
+		return _total;
+	}
+
+	inline uint64_t  min() const {
+		return _count ? _min : 0;
+	}
+
+	inline uint64_t  max() const {
+		return _max;
+	}
+
+	inline double  mean() const {
+		return _count ? (double) _total / _count : 0.0;
+	}
+
+	// The value below which p percent of the values fall (the highest value
+	// of its bucket, but not above the max)
+	uint64_t  percentile( const double p ) const
+	{
+		uint64_t  rank = (uint64_t) std::ceil( p / 100.0 * _count );
+		if( rank == 0 )
+			rank = 1;
+
+		uint64_t  seen = 0;
+		for( int i = 0; i != BUCKETS; ++i )
+		{
+			seen += _buckets[i];
+			if( seen >= rank )
+			{
+				const uint64_t  v = highest(i);
+				return v < _max ? (v < _min ? _min : v) : _max;
+			}
+		}
+
+		return _max;
+	}
+
+	// Text form: count, total, min, max, then the "bucket count" pairs of the
+	// nonempty buckets, ended by -1
+	void  write( std::ostream &os ) const
+	{
+		os << _count << ' ' << _total << ' ' << _min << ' ' << _max;
+		for( int i = 0; i != BUCKETS; ++i )
+			if( _buckets[i] )
+				os << ' ' << i << ' ' << _buckets[i];
+		os << " -1";
+	}
+
+	bool  read( std::istream &is )
+	{
+		Histogram  h;
+		if( !(is >> h._count >> h._total >> h._min >> h._max) )
+			return false;
+
+		int  i;
+		while( is >> i && i != -1 )
+			if( i < 0 || i >= BUCKETS || !(is >> h._buckets[i]) )
+				return false;
+
+		if( !is )
+			return false;
+
+		*this = h;
+		return true;
+	}
+
+private:
+	std::vector<uint64_t>  _buckets;
+	uint64_t  _count;
+	uint64_t  _total;
+	uint64_t  _min;
+	uint64_t  _max;
+
+	// The buckets from SUB_BUCKETS on hold the values with the same top
+	// PRECISION+1 bits
+	static inline int  bucket( uint64_t v )
+	{
+		if( v < SUB_BUCKETS )
+			return v;
+
+		if( v >> MAX_EXPONENT )
+			v = ((uint64_t) 1 << MAX_EXPONENT) - 1;
+
+		const int  shift = 63 - __builtin_clzll(v) - PRECISION;
+		return shift * SUB_BUCKETS + (int) (v >> shift);
+	}
+
+	static inline uint64_t  highest( const int i )
+	{
+		if( i < 2 * SUB_BUCKETS )
+			return i;
+
+		const int  shift = i / SUB_BUCKETS - 1;
+		return ((uint64_t) (i - shift * SUB_BUCKETS) << shift) + ((uint64_t) 1 << shift) - 1;
+	}
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SUDOKU_RANDOM_H
+#define SUDOKU_RANDOM_H
+#include <algorithm>
+#include <stdint.h>
+
+
+//NOTE: xorshift64 generator
+// Fast and reproducible, so two runs with the same seed make the same
+// tables. A stream number gives independent generators for the items of a
+// parallel run, which then do not depend on the number of threads.
+class Random
+{
+public:
+	inline explicit  Random( const uint64_t seed ) : _state(seed ? seed : 1)  {}
+
+	inline Random( const uint64_t seed, const uint64_t stream ) : _state( mix( seed + stream * 0x9E3779B97F4A7C15ull ) )  {}
+
+	inline uint64_t  next()
+	{
+		_state ^= _state << 13;
+		_state ^= _state >> 7;
+		_state ^= _state << 17;
+		return _state;
+	}
+
+	inline int  below( const int n ) {
+		return next() % n;
+	}
+
+	void  shuffle( int *items, const int n )
+	{
+		for( int i = n - 1; i > 0; --i )
+			std::swap( items[i], items[ below(i + 1) ] );
+	}
+
+private:
+	uint64_t  _state;
+
+	// The finalizer of splitmix64, so the close seeds give unrelated states
+	static uint64_t  mix( uint64_t x )
+	{
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		x ^= x >> 31;
+		return x ? x : 1;
+	}
+};
+
+#endif
@@ -6,60 +6,325 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <algorithm>
+#include <sstream>
 #include <iomanip>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <pthread.h>
 #include "sudoku/table.h"
 #include "sudoku/solver.h"
+#include "sudoku/bitsolver.h"
+#include "sudoku/batch.h"
+#include "sudoku/workpool.h"
+#include "sudoku/parallel.h"
+#include "sudoku/tiered.h"
+#include "sudoku/dlx.h"
+#include "sudoku/learning.h"
+#include "sudoku/solutions.h"
+#include "sudoku/reader.h"
+#include "sudoku/canonical.h"
+#include "sudoku/cache.h"
+#include "sudoku/database.h"
 #include "stopper.h"
+#include "histogram.h"
+#include "counters.h"
 
 
+//NOTE: Profile
+// The decisions, backsteps and time of every table are recorded into
+// histograms, so the report shows their distribution. The profiles of the
+// workers, and of separate runs (see -H), merge into one.
 struct PerformaceProfile
 {
 	long int  count;
 	long int  failed;
-	long int  total_decisions;
-	int  min_decisions;
-	int  max_decisions;
-	long int  total_backsteps;
-	int  min_backsteps;
-	int  max_backsteps;
+	long int  ambiguous; // more than one solution, when counting them
+	long int  cache_hits; // of the solution cache (they are not saved by write)
+	long int  cache_misses;
+	long int  database_hits; // of the solution database (not saved either)
+	long int  database_misses;
+	long int  tiers[sudoku::TieredSolver::TIERS]; // tables finished by each tier of the tiered engine
+	long int  nogoods; // learned by the learning engine, with its restarts and the levels it jumped
+	long int  restarts;
+	long int  backjumps;
 	double  total_time;
-	double  min_time;
-	double  max_time;
-
-	inline PerformaceProfile() 
-        : count(0), failed(0), total_decisions(0), min_decisions(100),
-        max_decisions(0), total_backsteps(0), min_backsteps(100),
-        max_backsteps(0), total_time(0.0), min_time(100.0), max_time(0.0)
-    { }
+	Histogram  decisions;
+	Histogram  backsteps;
+	Histogram  latency; // nanoseconds
+
+	// Hardware events, when counted (they are not saved by write)
+	Counters::Sample  events;
+	Histogram  cycles;
+
+	inline PerformaceProfile() : count(0), failed(0), ambiguous(0), cache_hits(0), cache_misses(0), database_hits(0), database_misses(0),
+		nogoods(0), restarts(0), backjumps(0), total_time(0.0)
+	{
+		for( int t = 0; t != sudoku::TieredSolver::TIERS; ++t )
+			tiers[t] = 0;
+	}
+
+	PerformaceProfile&  operator+= ( const PerformaceProfile &o )
+	{
+		count += o.count;
+		failed += o.failed;
+		ambiguous += o.ambiguous;
+		cache_hits += o.cache_hits;
+		cache_misses += o.cache_misses;
+		database_hits += o.database_hits;
+		database_misses += o.database_misses;
+		for( int t = 0; t != sudoku::TieredSolver::TIERS; ++t )
+			tiers[t] += o.tiers[t];
+		nogoods += o.nogoods;
+		restarts += o.restarts;
+		backjumps += o.backjumps;
+		total_time += o.total_time;
+		decisions += o.decisions;
+		backsteps += o.backsteps;
+		latency += o.latency;
+		events += o.events;
+		cycles += o.cycles;
+		return *this;
+	}
+
+	void  record( const bool solved, const int decisions, const int backsteps, const double elapsed )
+	{
+		++count;
+		if( !solved )
+			++failed;
+		this->decisions.record( decisions );
+		this->backsteps.record( backsteps );
+		latency.record( (uint64_t) (elapsed * 1e9 + 0.5) );
+		total_time += elapsed;
+	}
+
+	void  recordEvents( const Counters::Sample &s )
+	{
+		events += s;
+		if( s.has(Counters::CYCLES) )
+			cycles.record( s.values[Counters::CYCLES] );
+	}
+
+	void  write( std::ostream &os ) const
+	{
+		os << "sdk-batch-profile 1" << std::endl
+			<< count << ' ' << failed << ' ' << std::setprecision(17) << total_time << std::endl;
+		decisions.write(os);
+		os << std::endl;
+		backsteps.write(os);
+		os << std::endl;
+		latency.write(os);
+		os << std::endl;
+	}
+
+	bool  read( std::istream &is )
+	{
+		std::string  magic;
+		int  version;
+		PerformaceProfile  pp;
+		if( !(is >> magic >> version) || magic != "sdk-batch-profile" || version != 1 )
+			return false;
+
+		if( !(is >> pp.count >> pp.failed >> pp.total_time) || !pp.decisions.read(is)
+				|| !pp.backsteps.read(is) || !pp.latency.read(is) )
+			return false;
+
+		*this = pp;
+		return true;
+	}
 };
 
+inline void  print_value( std::ostream &os, const std::string &label, const std::string &value )
+{
+	os << label << std::setw(36 - label.size()) << value << std::endl;
+}
+
+inline std::string  format_number( const double v )
+{
+	std::ostringstream  s;
+	s << v;
+	return s.str();
+}
+
+// Events a per event b (times scale), n/a if either was not counted
+std::string  ratio( const Counters::Sample &s, const Counters::Event a, const Counters::Event b, const double scale )
+{
+	if( !s.has(a) || !s.has(b) || s.values[b] == 0 )
+		return "n/a";
+
+	return format_number( scale * s.values[a] / s.values[b] );
+}
+
+// The counters of a single table, next to its decisions and backsteps
+std::string  describe( const Counters::Sample &s, const int decisions, const int backsteps )
+{
+	std::ostringstream  d;
+	d << "decisions " << decisions << ", backsteps " << backsteps
+		<< ", IPC " << ratio( s, Counters::INSTRUCTIONS, Counters::CYCLES, 1.0 )
+		<< ", branch misses/kinstr " << ratio( s, Counters::BRANCH_MISSES, Counters::INSTRUCTIONS, 1000.0 )
+		<< ", L1D misses/kinstr " << ratio( s, Counters::L1D_MISSES, Counters::INSTRUCTIONS, 1000.0 )
+		<< ", LLC misses/kinstr " << ratio( s, Counters::LLC_MISSES, Counters::INSTRUCTIONS, 1000.0 );
+	return d.str();
+}
+
+// Min, percentiles and max of a histogram, scaled for printing
+void  print_distribution( std::ostream &os, const Histogram &h, const char *unit, const double scale )
+{
+	const std::string  u(unit);
+	os  << " Min" << u << ":" << std::setw(31 - u.size()) << h.min() * scale << std::endl
+		<< " p50" << u << ":" << std::setw(31 - u.size()) << h.percentile(50.0) * scale << std::endl
+		<< " p90" << u << ":" << std::setw(31 - u.size()) << h.percentile(90.0) * scale << std::endl
+		<< " p99" << u << ":" << std::setw(31 - u.size()) << h.percentile(99.0) * scale << std::endl
+		<< " p99.9" << u << ":" << std::setw(29 - u.size()) << h.percentile(99.9) * scale << std::endl
+		<< " Max" << u << ":" << std::setw(31 - u.size()) << h.max() * scale << std::endl;
+}
+
 std::ostream&  operator<< ( std::ostream &os, const PerformaceProfile &pp )
 {
 	os  << "Total count of tests:" << std::setw(15) << pp.count << std::endl
-		<< "Count of unsolvable tests:" << std::setw(10) << pp.failed << std::endl
-		<< std::endl << "DECISIONS" << std::endl
-		<< " Total:" << std::setw(29) << pp.total_decisions << std::endl
-		<< " Average:" << std::setw(27) << (double)pp.total_decisions / (double)pp.count << std::endl
-		<< " Min:" << std::setw(31) << pp.min_decisions << std::endl
-		<< " Max:" << std::setw(31) << pp.max_decisions << std::endl
-		<< std::endl << "BACKSTEPS" << std::endl
-		<< " Total:" << std::setw(29) << pp.total_backsteps << std::endl
-		<< " Average:" << std::setw(27) << (double)pp.total_backsteps / (double)pp.count << std::endl
-		<< " Min:" << std::setw(31) << pp.min_backsteps << std::endl
-		<< " Max:" << std::setw(31) << pp.max_backsteps << std::endl
-		<< std::endl << "TIME" << std::endl
+		<< "Count of unsolvable tests:" << std::setw(10) << pp.failed << std::endl;
+	if( pp.ambiguous )
+		os << "Count of ambiguous tests:" << std::setw(11) << pp.ambiguous << std::endl;
+
+	os  << std::endl << "DECISIONS" << std::endl
+		<< " Total:" << std::setw(29) << pp.decisions.total() << std::endl
+		<< " Average:" << std::setw(27) << pp.decisions.mean() << std::endl;
+	print_distribution( os, pp.decisions, "", 1.0 );
+
+	os  << std::endl << "BACKSTEPS" << std::endl
+		<< " Total:" << std::setw(29) << pp.backsteps.total() << std::endl
+		<< " Average:" << std::setw(27) << pp.backsteps.mean() << std::endl;
+	print_distribution( os, pp.backsteps, "", 1.0 );
+
+	os  << std::endl << "TIME" << std::endl
 		<< " Total (sec):" << std::setw(23) << pp.total_time << std::endl
-		<< " Average (millisec):" << std::setw(16) << pp.total_time / (double)pp.count * 1000.0 << std::endl
-		<< " Min (millisec):" << std::setw(20) << pp.min_time * 1000.0 << std::endl
-		<< " Max (millisec):" << std::setw(20) << pp.max_time * 1000.0 << std::endl;
+		<< " Average (millisec):" << std::setw(16) << pp.total_time / (double)pp.count * 1000.0 << std::endl;
+	print_distribution( os, pp.latency, " (millisec)", 1e-6 );
+
+	os  << " Tables/sec:" << std::setw(24) << (double)pp.count / pp.total_time << std::endl;
+
+	if( pp.cache_hits + pp.cache_misses )
+		os  << std::endl << "CACHE" << std::endl
+			<< " Hits:" << std::setw(30) << pp.cache_hits << std::endl
+			<< " Misses:" << std::setw(28) << pp.cache_misses << std::endl
+			<< " Hit rate (%):" << std::setw(22) << 100.0 * pp.cache_hits / (pp.cache_hits + pp.cache_misses) << std::endl;
+
+	if( pp.tiers[sudoku::TieredSolver::SINGLES] + pp.tiers[sudoku::TieredSolver::SEARCH] )
+		os  << std::endl << "TIERS" << std::endl
+			<< " Singles:" << std::setw(27) << pp.tiers[sudoku::TieredSolver::SINGLES] << std::endl
+			<< " Search:" << std::setw(28) << pp.tiers[sudoku::TieredSolver::SEARCH] << std::endl;
+
+	if( pp.nogoods + pp.restarts )
+		os  << std::endl << "LEARNING" << std::endl
+			<< " Nogoods:" << std::setw(27) << pp.nogoods << std::endl
+			<< " Restarts:" << std::setw(26) << pp.restarts << std::endl
+			<< " Levels jumped:" << std::setw(21) << pp.backjumps << std::endl;
+
+	if( pp.database_hits + pp.database_misses )
+		os  << std::endl << "DATABASE" << std::endl
+			<< " Hits:" << std::setw(30) << pp.database_hits << std::endl
+			<< " Misses:" << std::setw(28) << pp.database_misses << std::endl
+			<< " Hit rate (%):" << std::setw(22) << 100.0 * pp.database_hits / (pp.database_hits + pp.database_misses) << std::endl;
+
+	if( pp.events.mask )
+	{
+		os << std::endl << "COUNTERS" << std::endl;
+		for( int e = 0; e != Counters::EVENTS; ++e )
+			print_value( os, std::string(" ") + Counters::name( (Counters::Event) e ) + ":",
+				pp.events.has( (Counters::Event) e ) ? format_number( pp.events.values[e] ) : "n/a" );
+
+		print_value( os, " IPC:", ratio( pp.events, Counters::INSTRUCTIONS, Counters::CYCLES, 1.0 ) );
+		print_value( os, " Branch misses/kinstr:", ratio( pp.events, Counters::BRANCH_MISSES, Counters::INSTRUCTIONS, 1000.0 ) );
+		print_value( os, " L1D misses/kinstr:", ratio( pp.events, Counters::L1D_MISSES, Counters::INSTRUCTIONS, 1000.0 ) );
+		print_value( os, " LLC misses/kinstr:", ratio( pp.events, Counters::LLC_MISSES, Counters::INSTRUCTIONS, 1000.0 ) );
+		if( pp.cycles.count() )
+			print_distribution( os, pp.cycles, " (cycles)", 1.0 );
+	}
+
+	return os;
+}
+
+
+struct ParseProfile
+{
+	long int  count;
+	long int  skipped;
+	double  bytes;
+	double  time;
+
+	inline ParseProfile() : count(0), skipped(0), bytes(0.0), time(0.0)  {}
+};
+
+std::ostream&  operator<< ( std::ostream &os, const ParseProfile &pp )
+{
+	os  << "PARSING" << std::endl
+		<< " Tables:" << std::setw(28) << pp.count << std::endl
+		<< " Skipped:" << std::setw(27) << pp.skipped << std::endl
+		<< " Total (sec):" << std::setw(23) << pp.time << std::endl
+		<< " Tables/sec:" << std::setw(24) << pp.count / pp.time << std::endl
+		<< " MB/sec:" << std::setw(28) << pp.bytes / pp.time / 1e6 << std::endl;
 
 	return os;
 }
 
 
-inline void  measure( const sudoku::Table &in, sudoku::Table &out, PerformaceProfile &pp )
+struct Options
 {
-	sudoku::Solver  solver;
+	const char  *engine;
+	int  size;
+	int  jobs;
+	bool  lines;
+	bool  mapped;
+	bool  packed;
+	const char  *input;
+	const char  *history;
+	bool  counters;
+	int  limit;
+	bool  stream;
+	long  cache; // capacity of the solution cache, 0 for none
+	const char  *database;
+
+	inline Options() : engine("cube"), size(9), jobs(1), lines(false), mapped(false), packed(false), input(0), history(0), counters(false),
+		limit(0), stream(false), cache(0), database(0)  {}
+
+	inline sudoku::MappedCorpus::Format  format() const {
+		return packed ? sudoku::MappedCorpus::PACKED : (lines ? sudoku::MappedCorpus::LINES : sudoku::MappedCorpus::TABLES);
+	}
+
+	// Whether the input is a corpus of tables, which are solved into the output
+	inline bool  corpus() const {
+		return lines || mapped;
+	}
+};
+
+// What the search of some engines did beyond the decisions and backsteps:
+// which tier finished the table, what the learning engine learned
+template< typename SOLVER >
+inline void  record_search( const SOLVER&, PerformaceProfile& )
+{}
+
+inline void  record_search( const sudoku::TieredSolver &solver, PerformaceProfile &pp )
+{
+	++pp.tiers[ solver.tier() ];
+}
+
+template< int BOX >
+inline void  record_search( const sudoku::BasicLearningSolver<BOX> &solver, PerformaceProfile &pp )
+{
+	pp.nogoods += solver.nogoods();
+	pp.restarts += solver.restarts();
+	pp.backjumps += solver.backjumps();
+}
+
+template< typename SOLVER >
+inline void  measure( SOLVER &solver, const typename SOLVER::TableType &in, typename SOLVER::TableType &out, PerformaceProfile &pp,
+		Counters *counters = 0 )
+{
+	//NOTE: the counters are read outside of the timed part
+	if( counters )
+		counters->start();
 
 	// Start stopper...
 	Stopper  stopper;
@@ -71,30 +336,169 @@ inline void  measure( const sudoku::Table &in, sudoku::Table &out, PerformacePro
 	// End stopper
 	double  elapsed = stopper.elapsed();
 
+	if( counters )
+	{
+		counters->stop();
+		pp.recordEvents( counters->last() );
+	}
+
 	// Update profiling info 
-	++pp.count;
-	if( !solved )
-        ++pp.failed;
-	pp.total_decisions += solver.decisions();
-	if( solver.decisions() < pp.min_decisions )
-        pp.min_decisions = solver.decisions();
-	if( pp.max_decisions < solver.decisions() )
-        pp.max_decisions = solver.decisions();
-	pp.total_backsteps += solver.backsteps();
-	if( solver.backsteps() < pp.min_backsteps )
-        pp.min_backsteps = solver.backsteps();
-	if( pp.max_backsteps < solver.backsteps() )
-        pp.max_backsteps = solver.backsteps();
-	pp.total_time += elapsed;
-	if( elapsed < pp.min_time )
-        pp.min_time = elapsed;	
-	if( pp.max_time < elapsed )
-        pp.max_time = elapsed;
-}
-
-void  run_tests( std::istream &samples_refs, PerformaceProfile &pp )
-{
-	sudoku::Table  table;
+	pp.record( solved, solver.decisions(), solver.backsteps(), elapsed );
+	record_search( solver, pp );
+}
+
+// The cache holds 9x9 tables only
+template< typename SOLVER, typename TABLE >
+inline void  measure_cached( SOLVER &solver, const TABLE &in, TABLE &out, PerformaceProfile &pp, sudoku::SolutionCache &,
+		Counters *counters = 0 )
+{
+	measure( solver, in, out, pp, counters );
+}
+
+//NOTE: Cached solve
+// The table is mapped to its canonical form first. A form seen before is
+// answered by mapping its cached solution back, without a search, so the
+// hit is recorded with no decisions. Otherwise the table is solved, and
+// its solution is cached in the canonical form.
+template< typename SOLVER >
+void  measure_cached( SOLVER &solver, const sudoku::Table &in, sudoku::Table &out, PerformaceProfile &pp, sudoku::SolutionCache &cache,
+		Counters *counters = 0 )
+{
+	if( counters )
+		counters->start();
+
+	Stopper  stopper;
+
+	sudoku::Table  form, solution;
+	sudoku::Transform  transform;
+	sudoku::canonicalize( in, form, transform );
+
+	bool  solved;
+	int  decisions = 0, backsteps = 0;
+	if( cache.find( form, solution ) )
+	{
+		solved = true;
+		transform.revert( solution, out );
+		++pp.cache_hits;
+	}
+	else
+	{
+		//NOTE: out may be the same table as in
+		solver.init(in);
+		solved = solver.run();
+		solver.extractTable(out);
+		decisions = solver.decisions();
+		backsteps = solver.backsteps();
+		record_search( solver, pp );
+
+		if( solved )
+		{
+			transform.apply( out, solution );
+			cache.insert( form, solution );
+		}
+		++pp.cache_misses;
+	}
+
+	double  elapsed = stopper.elapsed();
+
+	if( counters )
+	{
+		counters->stop();
+		pp.recordEvents( counters->last() );
+	}
+
+	pp.record( solved, decisions, backsteps, elapsed );
+}
+
+// The database holds 9x9 tables only
+template< typename TABLE >
+inline bool  measure_stored( const sudoku::SolutionDatabase&, TABLE&, PerformaceProfile& )
+{
+	return false;
+}
+
+// Looks the table up in the database, a hit is recorded as a solve with no
+// decisions, a miss is left to the solver
+inline bool  measure_stored( const sudoku::SolutionDatabase &database, sudoku::Table &table, PerformaceProfile &pp )
+{
+	Stopper  stopper;
+	const bool  found = database.find( table, table );
+	const double  elapsed = stopper.elapsed();
+
+	if( found )
+	{
+		pp.record( true, 0, 0, elapsed );
+		++pp.database_hits;
+	}
+	else
+		++pp.database_misses;
+
+	return found;
+}
+
+// The solutions kept by measure_solutions()
+template< typename SOLVER >
+struct KeepSolutions
+{
+	typedef typename SOLVER::TableType  TableType;
+
+	TableType  *out;
+	std::vector<TableType>  *found;
+	bool  first;
+
+	inline void  operator() ( const SOLVER &solver )
+	{
+		if( found )
+		{
+			found->push_back( TableType() );
+			solver.extractTable( found->back() );
+		}
+		else if( first )
+			solver.extractTable(*out);
+
+		first = false;
+	}
+};
+
+// Counts the solutions up to the limit, the first one is written to out, or
+// if found is given, every solution is added to it
+template< typename SOLVER >
+inline int  measure_solutions( SOLVER &solver, const typename SOLVER::TableType &in, typename SOLVER::TableType &out,
+		std::vector<typename SOLVER::TableType> *found, const int limit, PerformaceProfile &pp, Counters *counters = 0 )
+{
+	if( counters )
+		counters->start();
+
+	Stopper  stopper;
+
+	solver.init(in);
+	KeepSolutions<SOLVER>  keep = { &out, found, true };
+	const int  count = sudoku::countSolutions( solver, limit, keep );
+
+	double  elapsed = stopper.elapsed();
+
+	if( counters )
+	{
+		counters->stop();
+		pp.recordEvents( counters->last() );
+	}
+
+	pp.record( count != 0, solver.decisions(), solver.backsteps(), elapsed );
+	record_search( solver, pp );
+	if( count > 1 )
+		++pp.ambiguous;
+
+	return count;
+}
+
+template< typename SOLVER >
+void  run_tests( SOLVER &solver, std::istream &samples_refs, PerformaceProfile &pp, const bool counting )
+{
+	typename SOLVER::TableType  table;
+
+	Counters  counters;
+	if( counting )
+		counters.open();
 
 	while( !samples_refs.eof() )
 	{
@@ -113,21 +517,696 @@ void  run_tests( std::istream &samples_refs, PerformaceProfile &pp )
 		std::cout << "Using sample file '" << buff << "'...  " << std::flush;
 
 		sample >> table;		
-		measure(table, table, pp);
+		measure(solver, table, table, pp, counting ? &counters : 0);
+
+		std::cout << "OK";
+		if( counting )
+			std::cout << "  (" << describe( counters.last(), solver.decisions(), solver.backsteps() ) << ")";
+		std::cout << std::endl;
+	}
+}
+
+template< typename SOLVER >
+inline void  run_tests( std::istream &samples_refs, PerformaceProfile &pp, const bool counting )
+{
+	SOLVER  solver;
+	run_tests( solver, samples_refs, pp, counting );
+}
+
+
+// Every worker of the pool has its own solver and profile
+template< typename SOLVER >
+class SolverJob : public sudoku::WorkPool::Job
+{
+public:
+	inline  SolverJob( const int workers, const bool counting ) : _workers(workers), _counting(counting)  {}
+
+	// The counters are opened by the thread of the worker
+	virtual void  enter( const int worker )
+	{
+		if( _counting )
+			_workers[worker].counters.open();
+	}
+
+	virtual void  leave( const int worker )
+	{
+		if( _counting )
+			_workers[worker].counters.close();
+	}
+
+	void  mergeProfiles( PerformaceProfile &pp ) const
+	{
+		for( size_t i = 0; i != _workers.size(); ++i )
+			pp += _workers[i].pp;
+	}
+
+protected:
+	struct Worker
+	{
+		PerformaceProfile  pp;
+		SOLVER  solver;
+		Counters  counters;
+		char  padding[64]; // keep the next worker's profile off our cache line
+	};
+
+	std::vector<Worker>  _workers;
+	bool  _counting;
+
+	inline Counters*  counters( const int worker ) {
+		return _counting ? &_workers[worker].counters : 0;
+	}
+};
+
+//NOTE: Parallel batch
+// The samples are spread over the workers of a work-stealing pool. The
+// reports are printed in the order of the sample list, so the output
+// matches the sequential run.
+template< typename SOLVER >
+class BatchJob : public SolverJob<SOLVER>
+{
+public:
+	BatchJob( const std::vector<std::string> &samples, const int workers, const bool counting )
+		: SolverJob<SOLVER>(workers, counting), _samples(samples), _reports(samples.size()), _done(samples.size(), false), _printed(0)
+	{
+		pthread_mutex_init( &_output, 0 );
+	}
+
+	~BatchJob()
+	{
+		pthread_mutex_destroy( &_output );
+	}
+
+	virtual void  process( const int worker, const long item )
+	{
+		const std::string  &path = _samples[item];
+		std::ostringstream  report;
+
+		std::ifstream  sample( path.c_str() );
+		if( !sample )
+			report << "Failed to open sample file '" << path << "'" << std::endl;
+		else
+		{
+			typename SOLVER::TableType  table;
+			sample >> table;
+			measure( this->_workers[worker].solver, table, table, this->_workers[worker].pp, this->counters(worker) );
+
+			report << "Using sample file '" << path << "'...  OK";
+			if( this->_counting )
+				report << "  (" << describe( this->_workers[worker].counters.last(),
+					this->_workers[worker].solver.decisions(), this->_workers[worker].solver.backsteps() ) << ")";
+			report << std::endl;
+		}
+
+		pthread_mutex_lock( &_output );
+
+		_reports[item] = report.str();
+		_done[item] = true;
+		for( ; _printed != _samples.size() && _done[_printed]; ++_printed )
+		{
+			std::cout << _reports[_printed] << std::flush;
+			_reports[_printed].clear();
+		}
+
+		pthread_mutex_unlock( &_output );
+	}
+
+private:
+	const std::vector<std::string>  &_samples;
+
+	pthread_mutex_t  _output;
+	std::vector<std::string>  _reports;
+	std::vector<bool>  _done;
+	size_t  _printed;
+};
+
+template< typename SOLVER >
+void  run_parallel_tests( std::istream &samples_refs, PerformaceProfile &pp, const int jobs, const bool counting )
+{
+	std::vector<std::string>  samples;
+	while( !samples_refs.eof() )
+	{
+		char  buff[256];
+		samples_refs.getline(buff, 256);
+
+		if( buff[0] == '#' || buff[0] == 0 )
+			continue;
 
-		std::cout << "OK" << std::endl;
+		samples.push_back(buff);
 	}
+
+	sudoku::WorkPool  pool(jobs);
+	BatchJob<SOLVER>  job( samples, pool.workers(), counting );
+	pool.run( job, samples.size() );
+	job.mergeProfiles(pp);
 }
 
 
+//NOTE: Corpus mode
+// The puzzles are read from a corpus a block at a time, solved on the
+// pool, and the solutions are written in the one-line format, in order.
+template< typename SOLVER >
+class CorpusJob : public SolverJob<SOLVER>
+{
+public:
+	typedef typename SOLVER::TableType  TableType;
+
+	std::vector<TableType>  tables;
+
+	inline  CorpusJob( const int workers, const Options &options )
+		: SolverJob<SOLVER>(workers, options.counters), _cache(options.cache), _database(options.database)  {}
+
+	// Number of pool items for a block of tables
+	inline long  items( const size_t count ) {
+		return count;
+	}
+
+	virtual void  process( const int worker, const long item )
+	{
+		if( _database.isOpen() && measure_stored( _database, tables[item], this->_workers[worker].pp ) )
+			return;
+
+		if( _cache.enabled() )
+			measure_cached( this->_workers[worker].solver, tables[item], tables[item], this->_workers[worker].pp, _cache,
+				this->counters(worker) );
+		else
+			measure( this->_workers[worker].solver, tables[item], tables[item], this->_workers[worker].pp, this->counters(worker) );
+	}
+
+	// Writes the solutions of the first count tables, the first of them is
+	// the given table of the corpus
+	void  write( std::ostream &out, const size_t count, const long )
+	{
+		for( size_t i = 0; i != count; ++i )
+			out << sudoku::BasicLineTable<TableType::Box>(tables[i]) << '\n';
+	}
+
+private:
+	sudoku::SolutionCache  _cache; // shared by the workers, over the blocks
+	sudoku::SolutionDatabase  _database;
+};
+
+//NOTE: Counting mode
+// The solutions of every table are counted up to the limit. A table gets a
+// line with its first solution and the count, or when streaming, every
+// solution found gets a line with the number of its table in the corpus.
+template< typename SOLVER >
+class CountingJob : public SolverJob<SOLVER>
+{
+public:
+	typedef typename SOLVER::TableType  TableType;
+
+	std::vector<TableType>  tables;
+
+	inline  CountingJob( const int workers, const Options &options )
+		: SolverJob<SOLVER>(workers, options.counters), _limit(options.limit), _stream(options.stream)  {}
+
+	inline long  items( const size_t count )
+	{
+		_counts.resize(count);
+		if( _stream )
+			_solutions.resize(count);
+		return count;
+	}
+
+	virtual void  process( const int worker, const long item )
+	{
+		std::vector<TableType>  *found = _stream ? &_solutions[item] : 0;
+		if( found )
+			found->clear();
+
+		_counts[item] = measure_solutions( this->_workers[worker].solver, tables[item], tables[item], found, _limit,
+			this->_workers[worker].pp, this->counters(worker) );
+	}
+
+	void  write( std::ostream &out, const size_t count, const long first )
+	{
+		for( size_t i = 0; i != count; ++i )
+			if( _stream )
+				for( size_t j = 0; j != _solutions[i].size(); ++j )
+					out << sudoku::BasicLineTable<TableType::Box>(_solutions[i][j]) << ' ' << first + i + 1 << '\n';
+			else
+				out << sudoku::BasicLineTable<TableType::Box>(tables[i]) << ' ' << _counts[i] << '\n';
+	}
+
+private:
+	int  _limit;
+	bool  _stream;
+	std::vector<int>  _counts;
+	std::vector< std::vector<TableType> >  _solutions;
+};
+
+// The batch engine: the items are chunks of tables, solved in lockstep
+class LockstepJob : public SolverJob<sudoku::BatchSolver>
+{
+public:
+	typedef sudoku::Table  TableType;
+
+	std::vector<TableType>  tables;
+
+	inline  LockstepJob( const int workers, const Options &options ) : SolverJob<sudoku::BatchSolver>(workers, options.counters), _count(0)  {}
+
+	inline long  items( const size_t count ) {
+		_count = count;
+		return (count + CHUNK - 1) / CHUNK;
+	}
+
+	virtual void  process( const int worker, const long item )
+	{
+		sudoku::Table  *chunk = &tables[item * CHUNK];
+		const size_t  n = std::min( (size_t) CHUNK, _count - item * CHUNK );
+
+		if( _counting )
+			_workers[worker].counters.start();
+
+		Stopper  stopper;
+		_workers[worker].solver.solveBatch( chunk, chunk, n );
+		const double  elapsed = stopper.elapsed();
+
+		//NOTE: the tables of a chunk are solved together, they share its time
+		// and its events
+		Counters::Sample  share;
+		if( _counting )
+		{
+			_workers[worker].counters.stop();
+			share = _workers[worker].counters.last();
+			for( int e = 0; e != Counters::EVENTS; ++e )
+				share.values[e] /= n;
+		}
+
+		for( size_t i = 0; i != n; ++i )
+		{
+			const sudoku::BatchSolver::Outcome  &o = _workers[worker].solver.outcome(i);
+			_workers[worker].pp.record( o.solved, o.decisions, o.backsteps, elapsed / n );
+			if( _counting )
+				_workers[worker].pp.recordEvents(share);
+		}
+	}
+
+	void  write( std::ostream &out, const size_t count, const long )
+	{
+		for( size_t i = 0; i != count; ++i )
+			out << sudoku::LineTable(tables[i]) << '\n';
+	}
+
+private:
+	enum {
+		CHUNK = 256,
+	};
+
+	size_t  _count;
+};
+
+// Reads the one-line format from a stream
+class LineReader
+{
+public:
+	inline explicit  LineReader( std::istream &in ) : _in(in), _number(0), _consumed(0), _skipped(0)  {}
+
+	template< int BOX >
+	bool  next( sudoku::BasicTable<BOX> &t )
+	{
+		while( std::getline(_in, _line) )
+		{
+			++_number;
+			_consumed += _line.size() + 1;
+
+			if( _line.empty() || _line[0] == '#' )
+				continue;
+
+			if( sudoku::readLine( _line.c_str(), _line.size(), t ) )
+				return true;
+
+			std::cerr << "Skipping malformed line " << _number << std::endl;
+			++_skipped;
+		}
+
+		return false;
+	}
+
+	inline size_t  position() const {
+		return _consumed;
+	}
+
+	inline long  skipped() const {
+		return _skipped;
+	}
+
+private:
+	std::istream  &_in;
+	std::string  _line;
+	long  _number;
+	size_t  _consumed;
+	long  _skipped;
+};
+
+template< typename JOB, typename READER >
+void  run_corpus( READER &reader, std::ostream &out, PerformaceProfile &pp, ParseProfile &parsing, const Options &options )
+{
+	const size_t  block = 4096;
+
+	sudoku::WorkPool  pool( options.jobs );
+	JOB  job( pool.workers(), options );
+	job.tables.resize(block);
+
+	size_t  count;
+	do
+	{
+		Stopper  stopper;
+		for( count = 0; count != block && reader.next( job.tables[count] ); ++count );
+		parsing.time += stopper.elapsed();
+		parsing.count += count;
+
+		pool.run( job, job.items(count) );
+		job.write( out, count, parsing.count - count );
+	}
+	while( count == block );
+
+	out.flush();
+	job.mergeProfiles(pp);
+
+	parsing.bytes = reader.position();
+	parsing.skipped = reader.skipped();
+}
+
+
+template< typename JOB >
+int  run_corpus_input( std::istream &in, PerformaceProfile &pp, ParseProfile &parsing, const Options &options )
+{
+	if( options.mapped )
+	{
+		sudoku::MappedCorpus  corpus( options.input, options.format() );
+		if( !corpus.isOpen() )
+		{
+			std::cerr << "Failed to map the input, it must be a regular file" << (options.packed ? " in the packed format" : "") << std::endl;
+			return -1;
+		}
+
+		run_corpus<JOB>( corpus, std::cout, pp, parsing, options );
+	}
+	else
+	{
+		LineReader  reader(in);
+		run_corpus<JOB>( reader, std::cout, pp, parsing, options );
+	}
+
+	return 0;
+}
+
+template< typename SOLVER >
+int  run( std::istream &in, PerformaceProfile &pp, ParseProfile &parsing, const Options &options )
+{
+	if( options.corpus() && options.limit )
+		return run_corpus_input< CountingJob<SOLVER> >( in, pp, parsing, options );
+	else if( options.corpus() )
+		return run_corpus_input< CorpusJob<SOLVER> >( in, pp, parsing, options );
+	else if( options.jobs > 1 )
+		run_parallel_tests<SOLVER>( in, pp, options.jobs, options.counters );
+	else
+		run_tests<SOLVER>( in, pp, options.counters );
+
+	return 0;
+}
+
+// The engines solving one table at a time with the interface of Solver, so
+// they can count the solutions and use the cache
+bool  single_table_engine( const char *engine )
+{
+	return strcmp(engine, "cube") == 0 || strcmp(engine, "bits") == 0 || strcmp(engine, "tiered") == 0
+		|| strcmp(engine, "dlx") == 0 || strcmp(engine, "learning") == 0;
+}
+
+// The engines on digit masks, bits and learning, handle every table size
+template< template< int > class SOLVER >
+int  run_sized( std::istream &in, PerformaceProfile &pp, ParseProfile &parsing, const Options &options )
+{
+	switch( options.size )
+	{
+	case 4:
+		return run< SOLVER<2> >(in, pp, parsing, options);
+
+	case 16:
+		return run< SOLVER<4> >(in, pp, parsing, options);
+
+	case 25:
+		return run< SOLVER<5> >(in, pp, parsing, options);
+
+	default:
+		return run< SOLVER<3> >(in, pp, parsing, options);
+	}
+}
+
+
+//NOTE: Accumulated profile
+// The histograms of several runs (e.g. on the shards of a corpus) are
+// merged in a file, so the percentiles of all of them can be read together.
+int  accumulate( const char *path, const PerformaceProfile &pp, std::ostream &report )
+{
+	PerformaceProfile  history;
+
+	std::ifstream  saved(path);
+	if( saved && !history.read(saved) )
+	{
+		std::cerr << "The profile file '" << path << "' is malformed" << std::endl;
+		return -1;
+	}
+	saved.close();
+
+	history += pp;
+
+	std::ofstream  out(path);
+	history.write(out);
+	if( !out )
+	{
+		std::cerr << "Failed to write the profile file '" << path << "'" << std::endl;
+		return -1;
+	}
+
+	report << std::endl << "ACCUMULATED IN '" << path << "'" << std::endl << std::endl << history;
+	return 0;
+}
+
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-e cube|bits|tiered|dlx|learning|batch|parallel] [-k KERNEL] [-s SIZE] [-j N] [-l] [-m] [-p] [-H FILE] [-c] [-n LIMIT [-a]] [-C SIZE] [-D FILE] [input]" << std::endl
+		<< "  -e ENGINE  solver engine to measure (default: cube), the batch engine" << std::endl
+		<< "             solves many tables in lockstep, it needs -l, -m or -p, the" << std::endl
+		<< "             parallel engine splits the search of each sample over -j threads," << std::endl
+		<< "             the tiered engine tries the singles before the cube search," << std::endl
+		<< "             the dlx engine runs the dancing links on the exact cover of the cube," << std::endl
+		<< "             the learning engine learns nogoods from the conflicts and jumps back" << std::endl
+		<< "  -k KERNEL  kernel of the batch engine: scalar, sse2 or avx2" << std::endl
+		<< "             (default: the best one the machine supports)" << std::endl
+		<< "  -s SIZE    side of the tables: 4, 9, 16 or 25 (default: 9), the sizes" << std::endl
+		<< "             other than 9 need the bits or learning engine and a text input" << std::endl
+		<< "  -j N       solve the samples on N threads (default: 1)" << std::endl
+		<< "  -l         the input has one puzzle per line instead of sample file" << std::endl
+		<< "             paths, the solutions are written to the output the same way" << std::endl
+		<< "  -m         memory-map the input, it is a corpus of tables (or lines with -l)" << std::endl
+		<< "             and the solutions are written to the output as with -l" << std::endl
+		<< "  -p         like -m, but the input is a packed corpus (see sdk-convert)" << std::endl
+		<< "  -H FILE    add the profile to the one saved in FILE (created if missing)," << std::endl
+		<< "             and report the accumulated profile too" << std::endl
+		<< "  -c         count the hardware events of every solve (cycles, instructions," << std::endl
+		<< "             branch and cache misses), if the system allows it" << std::endl
+		<< "  -n LIMIT   count the solutions of the tables up to LIMIT (0: all of them)," << std::endl
+		<< "             the first solution is written with the count after it, it" << std::endl
+		<< "             needs -l, -m or -p, and the cube, bits, tiered, dlx or learning" << std::endl
+		<< "             engine" << std::endl
+		<< "  -a         with -n, write every solution found, with the number of its table" << std::endl
+		<< "  -C SIZE    cache up to SIZE solutions by the canonical form of the tables," << std::endl
+		<< "             so the tables equivalent by symmetry to a solved one are not" << std::endl
+		<< "             searched, it needs -l, -m or -p, 9x9 tables, the cube, bits," << std::endl
+		<< "             tiered, dlx or learning engine, and no -n" << std::endl
+		<< "  -D FILE    look the tables up in a solution database (see sdk-db) before" << std::endl
+		<< "             solving them, it needs the same as -C" << std::endl
+		<< "  input      read from this file instead of the standard input" << std::endl;
+}
+
 int  main( int argc, char *argv[] )
 {
+	Options  options;
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "e:k:s:j:lmpH:cn:aC:D:h")) != -1 )
+		switch( opt )
+		{
+		case 'e':
+			options.engine = optarg;
+			break;
+
+		case 'k':
+			if( !sudoku::BatchSolver::selectKernel(optarg) )
+			{
+				std::cerr << "The '" << optarg << "' kernel is not supported" << std::endl;
+				return -1;
+			}
+			break;
+
+		case 's':
+			options.size = atoi(optarg);
+			if( options.size != 4 && options.size != 9 && options.size != 16 && options.size != 25 )
+			{
+				std::cerr << "The table size must be 4, 9, 16 or 25" << std::endl;
+				return -1;
+			}
+			break;
+
+		case 'j':
+			options.jobs = atoi(optarg);
+			break;
+
+		case 'l':
+			options.lines = true;
+			break;
+
+		case 'm':
+			options.mapped = true;
+			break;
+
+		case 'p':
+			options.mapped = options.packed = true;
+			break;
+
+		case 'H':
+			options.history = optarg;
+			break;
+
+		case 'c':
+			options.counters = true;
+			break;
+
+		case 'n':
+			options.limit = atoi(optarg);
+			//NOTE: 0 counts every solution
+			if( options.limit == 0 )
+				options.limit = -1;
+			break;
+
+		case 'a':
+			options.stream = true;
+			break;
+
+		case 'C':
+			options.cache = atol(optarg);
+			break;
+
+		case 'D':
+			options.database = optarg;
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	if( options.size != 9 && ((strcmp(options.engine, "bits") != 0 && strcmp(options.engine, "learning") != 0) || options.packed) )
+	{
+		std::cerr << "Only the bits and learning engines and the text formats support " << options.size << "x" << options.size << " tables" << std::endl;
+		return -1;
+	}
+
+	//NOTE: the counters would see the calling thread only
+	if( strcmp(options.engine, "parallel") == 0 && (options.corpus() || options.counters) )
+	{
+		std::cerr << "The parallel engine needs a list of sample files, and no -c" << std::endl;
+		return -1;
+	}
+
+	if( options.limit && (!options.corpus() || !single_table_engine(options.engine)) )
+	{
+		std::cerr << "Counting the solutions needs -l, -m or -p, and the cube, bits, tiered, dlx or learning engine" << std::endl;
+		return -1;
+	}
+
+	if( (options.cache || options.database) && (!options.corpus() || options.size != 9 || options.limit
+			|| !single_table_engine(options.engine)) )
+	{
+		std::cerr << "The solution cache and database need -l, -m or -p, 9x9 tables, the cube, bits, tiered, dlx or learning engine, and no -n" << std::endl;
+		return -1;
+	}
+
+	if( options.database )
+	{
+		sudoku::SolutionDatabase  probe( options.database );
+		if( !probe.isOpen() )
+		{
+			std::cerr << "Failed to map the solution database '" << options.database << "'" << std::endl;
+			return -1;
+		}
+	}
+
+	if( options.counters )
+	{
+		Counters  probe;
+		if( !probe.open() )
+		{
+			std::cerr << "Hardware counters are not available (" << probe.error() << "), measuring without them" << std::endl;
+			options.counters = false;
+		}
+	}
+
+	std::ios::sync_with_stdio(false);
+
+	std::ifstream  file;
+	if( optind < argc )
+		options.input = argv[optind];
+
+	if( options.input && !options.mapped )
+	{
+		file.open( argv[optind] );
+		if( !file )
+		{
+			std::cerr << "Failed to open input file '" << argv[optind] << "'" << std::endl;
+			return -1;
+		}
+	}
+	std::istream  &in = file.is_open() ? file : std::cin;
+
 	PerformaceProfile pp;
-	run_tests(std::cin, pp);
+	ParseProfile  parsing;
+	int  result;
+	if( strcmp(options.engine, "cube") == 0 )
+		result = run<sudoku::Solver>(in, pp, parsing, options);
+	else if( strcmp(options.engine, "bits") == 0 )
+		result = run_sized<sudoku::BasicBitSolver>(in, pp, parsing, options);
+	else if( strcmp(options.engine, "tiered") == 0 )
+		result = run<sudoku::TieredSolver>(in, pp, parsing, options);
+	else if( strcmp(options.engine, "dlx") == 0 )
+		result = run<sudoku::DlxSolver>(in, pp, parsing, options);
+	else if( strcmp(options.engine, "learning") == 0 )
+		result = run_sized<sudoku::BasicLearningSolver>(in, pp, parsing, options);
+	else if( strcmp(options.engine, "batch") == 0 && options.corpus() )
+		result = run_corpus_input<LockstepJob>(in, pp, parsing, options);
+	else if( strcmp(options.engine, "parallel") == 0 )
+	{
+		sudoku::ParallelSolver  solver( options.jobs );
+		run_tests( solver, in, pp, false );
+		result = 0;
+	}
+	else
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	if( result != 0 )
+		return result;
+
+	// In corpus mode the standard output carries the solutions
+	std::ostream  &report = options.corpus() ? std::cerr : std::cout;
+	report << std::endl << "Finished testing sudoku solver (" << options.engine << " engine";
+	if( options.size != 9 )
+		report << ", " << options.size << "x" << options.size << " tables";
+	if( strcmp(options.engine, "batch") == 0 )
+		report << ", " << sudoku::BatchSolver::kernel() << " kernel";
+	report << ")" << std::endl << std::endl << pp;
 
-	std::cout << std::endl << "Finished testing sudoku solver" <<
-        std::endl << std::endl << pp;
+	if( options.corpus() )
+		report << std::endl << parsing;
+
+	if( options.history )
+		return accumulate( options.history, pp, report );
 
 	return 0;
 }
-
@@ -0,0 +1,901 @@
+/*
+ * sdk-bench app.
+ * Written by Márk Szabadkai (mqrelly@gmail.com)
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <stdint.h>
+#include <new>
+#include <unistd.h>
+#include "sudoku/table.h"
+#include "sudoku/solver.h"
+#include "sudoku/bitsolver.h"
+#include "sudoku/tiered.h"
+#include "sudoku/dlx.h"
+#include "sudoku/learning.h"
+#include "sudoku/batch.h"
+#include "sudoku/reader.h"
+#include "stopper.h"
+#include "random.h"
+
+
+// The cube internals measured by the benchmarks
+struct sudoku::Solver::Probe
+{
+	typedef Solver::Cube  Cube;
+
+	static inline bool  deterministicMove( Solver &solver ) {
+		return solver.deterministicMove();
+	}
+};
+
+typedef sudoku::Solver::Probe::Cube  Cube;
+
+
+inline double  nanoseconds()
+{
+	return Stopper::now() * 1e9;
+}
+
+// Keeps the results of the measured calls alive
+volatile long  sink;
+
+
+//NOTE: Allocation count
+// Every allocation of the process goes through this operator new, so the
+// solvers can be checked to solve without the heap once they are warmed up
+// (see -a). The benchmarks run on one thread, a plain counter does.
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING  noexcept
+#else
+#define THROWS_BAD_ALLOC  throw(std::bad_alloc)
+#define THROWS_NOTHING  throw()
+#endif
+
+long  allocations = 0;
+
+//NOTE: not inlined, or GCC warns about free() on the memory of operator new
+__attribute__((noinline)) void*  operator new( size_t size ) THROWS_BAD_ALLOC
+{
+	++allocations;
+
+	void  *p = malloc( size ? size : 1 );
+	if( !p )
+		throw std::bad_alloc();
+	return p;
+}
+
+__attribute__((noinline)) void  operator delete( void *p ) THROWS_NOTHING
+{
+	free(p);
+}
+
+#if __cplusplus >= 201402L
+// C++14 deletes the objects of a known size through this one
+__attribute__((noinline)) void  operator delete( void *p, size_t ) THROWS_NOTHING
+{
+	free(p);
+}
+#endif
+
+
+//NOTE: Generated corpus
+// The puzzles are cut out of shuffled valid grids with a fixed seed, so two
+// builds measure the same corpus. They are graded by the decisions the
+// bitboard solver needs, the solutions are the ones it finds.
+
+// Rows (or columns) in a random order that keeps the bands together
+void  shuffleLines( Random &random, int *lines )
+{
+	int  bands[3] = { 0, 1, 2 };
+	random.shuffle( bands, 3 );
+
+	for( int b = 0; b != 3; ++b )
+	{
+		int  within[3] = { 0, 1, 2 };
+		random.shuffle( within, 3 );
+		for( int i = 0; i != 3; ++i )
+			lines[b * 3 + i] = bands[b] * 3 + within[i];
+	}
+}
+
+sudoku::Table  randomPuzzle( Random &random, const int clues )
+{
+	int  digits[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	int  rows[9], columns[9];
+	random.shuffle( digits, 9 );
+	shuffleLines( random, rows );
+	shuffleLines( random, columns );
+
+	int  cells[81];
+	for( int c = 0; c != 81; ++c )
+		cells[c] = c;
+	random.shuffle( cells, 81 );
+
+	sudoku::Table  t;
+	for( int i = 0; i != clues; ++i )
+	{
+		const int  x = cells[i] % 9, y = cells[i] / 9;
+		t(x,y) = digits[ (3 * (rows[y] % 3) + rows[y] / 3 + columns[x]) % 9 ];
+	}
+
+	return t;
+}
+
+
+struct Grade
+{
+	const char  *name;
+	int  max_decisions;
+
+	std::vector<sudoku::Table>  puzzles;
+	std::vector<sudoku::Table>  solutions;
+	std::string  lines; // the puzzles in the one-line format
+
+	inline Grade( const char *n, const int d ) : name(n), max_decisions(d)  {}
+
+	void  add( const sudoku::Table &puzzle, const sudoku::Table &solution )
+	{
+		std::ostringstream  line;
+		line << sudoku::LineTable(puzzle) << '\n';
+
+		puzzles.push_back(puzzle);
+		solutions.push_back(solution);
+		lines += line.str();
+	}
+};
+
+class Corpus
+{
+public:
+	std::vector<Grade>  grades;
+	Grade  all;
+
+	Corpus() : all("all", 0)
+	{
+		grades.push_back( Grade("easy", 0) );
+		grades.push_back( Grade("medium", 9) );
+		grades.push_back( Grade("hard", -1) );
+	}
+
+	// Grades the puzzle, returns false if its grade is full or it has no solution
+	bool  add( const sudoku::Table &puzzle, const size_t count )
+	{
+		_solver.init(puzzle);
+		if( !_solver.run() )
+			return false;
+
+		Grade  *grade = &grades.back();
+		for( size_t g = 0; g != grades.size(); ++g )
+			if( _solver.decisions() <= grades[g].max_decisions )
+			{
+				grade = &grades[g];
+				break;
+			}
+
+		if( grade->puzzles.size() == count )
+			return false;
+
+		sudoku::Table  solution;
+		_solver.extractTable(solution);
+		grade->add( puzzle, solution );
+		all.add( puzzle, solution );
+		return true;
+	}
+
+	void  generate( const uint64_t seed, const size_t count )
+	{
+		Random  random(seed);
+
+		//NOTE: the hard puzzles are rare, so the generation gives up after a while
+		for( size_t attempts = 0; !full(count) && attempts != count * 1000; ++attempts )
+			add( randomPuzzle( random, 20 + random.below(17) ), count );
+	}
+
+	bool  read( const char *path, const size_t count )
+	{
+		sudoku::MappedCorpus  corpus( path, sudoku::MappedCorpus::LINES );
+		if( !corpus.isOpen() )
+			return false;
+
+		sudoku::Table  puzzle;
+		while( !full(count) && corpus.next(puzzle) )
+			add( puzzle, count );
+
+		return true;
+	}
+
+private:
+	sudoku::BitSolver  _solver;
+
+	bool  full( const size_t count ) const
+	{
+		for( size_t g = 0; g != grades.size(); ++g )
+			if( grades[g].puzzles.size() != count )
+				return false;
+
+		return true;
+	}
+};
+
+
+//NOTE: Benchmarks
+// A run goes over the tables of a grade once and returns the nanoseconds
+// spent in the measured code. The setup of the tables (resetting a cube,
+// initializing a solver) is kept out of the measurement where it is not the
+// measured piece itself.
+class Benchmark
+{
+public:
+	virtual ~Benchmark()  {}
+
+	virtual const char*  name() const = 0;
+
+	// Graded benchmarks run on every grade, the others on all the tables
+	virtual bool  graded() const {
+		return true;
+	}
+
+	// Measured operations per table
+	virtual int  operations() const {
+		return 1;
+	}
+
+	// Shown after the times, about the last run
+	virtual std::string  note() const {
+		return std::string();
+	}
+
+	virtual double  run( const Grade &g ) = 0;
+};
+
+class MarkOccupied : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "cube.markOccupied";
+	}
+
+	virtual bool  graded() const {
+		return false;
+	}
+
+	virtual int  operations() const {
+		return 81;
+	}
+
+	// Marks every cell of the solutions on an empty cube
+	virtual double  run( const Grade &g )
+	{
+		double  elapsed = 0.0;
+		for( size_t i = 0; i != g.solutions.size(); ++i )
+		{
+			const sudoku::Table  &t = g.solutions[i];
+			_cube = _empty;
+
+			const double  start = nanoseconds();
+			for( int y = 0; y != 9; ++y )
+				for( int x = 0; x != 9; ++x )
+					_cube.cell( x, y, t(x,y) - 1 ).markOccupied();
+			elapsed += nanoseconds() - start;
+
+			sink += _cube.allAreasCompleted();
+		}
+
+		return elapsed;
+	}
+
+private:
+	const Cube  _empty;
+	Cube  _cube;
+};
+
+class DeterministicMove : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "solver.deterministicMove";
+	}
+
+	// The first move after init, which fills in what the givens imply
+	virtual double  run( const Grade &g )
+	{
+		double  elapsed = 0.0;
+		for( size_t i = 0; i != g.puzzles.size(); ++i )
+		{
+			_solver.init( g.puzzles[i] );
+
+			const double  start = nanoseconds();
+			sink += sudoku::Solver::Probe::deterministicMove(_solver);
+			elapsed += nanoseconds() - start;
+		}
+
+		return elapsed;
+	}
+
+private:
+	sudoku::Solver  _solver;
+};
+
+class Init : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "solver.init";
+	}
+
+	virtual double  run( const Grade &g )
+	{
+		const double  start = nanoseconds();
+		for( size_t i = 0; i != g.puzzles.size(); ++i )
+			_solver.init( g.puzzles[i] );
+
+		return nanoseconds() - start;
+	}
+
+private:
+	sudoku::Solver  _solver;
+};
+
+class Check : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "table.check";
+	}
+
+	virtual bool  graded() const {
+		return false;
+	}
+
+	virtual double  run( const Grade &g )
+	{
+		long  correct = 0;
+
+		const double  start = nanoseconds();
+		for( size_t i = 0; i != g.solutions.size(); ++i )
+			correct += g.solutions[i].check() == sudoku::Table::CORRECT;
+		const double  elapsed = nanoseconds() - start;
+
+		sink += correct;
+		return elapsed;
+	}
+};
+
+class Parse : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "table.parse";
+	}
+
+	// Reads the one-line format
+	virtual double  run( const Grade &g )
+	{
+		const char  *p = g.lines.data(), *end = p + g.lines.size();
+		sudoku::Table  t;
+		long  parsed = 0;
+
+		const double  start = nanoseconds();
+		while( p != end )
+		{
+			const char  *eol = (const char*) memchr( p, '\n', end - p );
+			parsed += sudoku::readLine( p, eol - p, t );
+			p = eol + 1;
+		}
+		const double  elapsed = nanoseconds() - start;
+
+		sink += parsed + t(0,0);
+		return elapsed;
+	}
+};
+
+class Format : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "table.format";
+	}
+
+	virtual bool  graded() const {
+		return false;
+	}
+
+	// Writes the one-line format
+	virtual double  run( const Grade &g )
+	{
+		_out.str( std::string() );
+
+		const double  start = nanoseconds();
+		for( size_t i = 0; i != g.solutions.size(); ++i )
+			_out << sudoku::LineTable( g.solutions[i] ) << '\n';
+		const double  elapsed = nanoseconds() - start;
+
+		sink += _out.tellp();
+		return elapsed;
+	}
+
+private:
+	std::ostringstream  _out;
+};
+
+template< typename SOLVER >
+class Solve : public Benchmark
+{
+public:
+	inline explicit  Solve( const char *name ) : _name(name)  {}
+
+	virtual const char*  name() const {
+		return _name;
+	}
+
+	// init, run and extractTable, as sdk-batch measures them
+	virtual double  run( const Grade &g )
+	{
+		sudoku::Table  out;
+		long  solved = 0;
+
+		_tables = g.puzzles.size();
+		_decisions = _backsteps = 0;
+
+		const double  start = nanoseconds();
+		for( size_t i = 0; i != g.puzzles.size(); ++i )
+		{
+			_solver.init( g.puzzles[i] );
+			solved += _solver.run();
+			_solver.extractTable(out);
+
+			_decisions += _solver.decisions();
+			_backsteps += _solver.backsteps();
+		}
+		const double  elapsed = nanoseconds() - start;
+
+		sink += solved + out(0,0);
+		return elapsed;
+	}
+
+	// Decisions and backsteps per table
+	virtual std::string  note() const
+	{
+		std::ostringstream  os;
+		os << std::fixed << std::setprecision(2) << "dec " << (double) _decisions / _tables
+			<< "  back " << (double) _backsteps / _tables;
+		return os.str();
+	}
+
+private:
+	const char  *_name;
+	SOLVER  _solver;
+	size_t  _tables;
+	long  _decisions;
+	long  _backsteps;
+};
+
+//NOTE: Propagation rules
+// The cube engine with one of the rules, or all of them (RULES), to weigh
+// the time of the rule against the decisions it saves.
+class SolveRules : public Benchmark
+{
+public:
+	inline explicit  SolveRules( const int rule ) : _rule(rule)
+	{
+		_name = std::string("solve.cube+") + ((rule == sudoku::Solver::RULES) ? "rules" : sudoku::Solver::ruleName( (sudoku::Solver::Rule) rule ));
+
+		for( int r = 0; r != sudoku::Solver::RULES; ++r )
+			if( r == rule || rule == sudoku::Solver::RULES )
+				_solver.enable( (sudoku::Solver::Rule) r );
+	}
+
+	virtual const char*  name() const {
+		return _name.c_str();
+	}
+
+	virtual double  run( const Grade &g )
+	{
+		sudoku::Table  out;
+		long  solved = 0;
+
+		_tables = g.puzzles.size();
+		_decisions = _backsteps = _eliminations = 0;
+
+		const double  start = nanoseconds();
+		for( size_t i = 0; i != g.puzzles.size(); ++i )
+		{
+			_solver.init( g.puzzles[i] );
+			solved += _solver.run();
+			_solver.extractTable(out);
+
+			_decisions += _solver.decisions();
+			_backsteps += _solver.backsteps();
+			for( int r = 0; r != sudoku::Solver::RULES; ++r )
+				_eliminations += _solver.eliminations( (sudoku::Solver::Rule) r );
+		}
+		const double  elapsed = nanoseconds() - start;
+
+		sink += solved + out(0,0);
+		return elapsed;
+	}
+
+	// Decisions, backsteps and eliminations per table
+	virtual std::string  note() const
+	{
+		std::ostringstream  os;
+		os << std::fixed << std::setprecision(2) << "dec " << (double) _decisions / _tables
+			<< "  back " << (double) _backsteps / _tables << "  elim " << (double) _eliminations / _tables;
+		return os.str();
+	}
+
+private:
+	int  _rule;
+	std::string  _name;
+	sudoku::Solver  _solver;
+	size_t  _tables;
+	long  _decisions;
+	long  _backsteps;
+	long  _eliminations;
+};
+
+class SolveBatch : public Benchmark
+{
+public:
+	virtual const char*  name() const {
+		return "solve.batch";
+	}
+
+	virtual double  run( const Grade &g )
+	{
+		_out.resize( g.puzzles.size() );
+
+		const double  start = nanoseconds();
+		sink += _solver.solveBatch( &g.puzzles[0], &_out[0], g.puzzles.size() );
+		return nanoseconds() - start;
+	}
+
+private:
+	sudoku::BatchSolver  _solver;
+	std::vector<sudoku::Table>  _out;
+};
+
+
+// Allocations per table of a solve (init, run, extractTable and next, as
+// sdk-batch and sdk-gen call them), the first pass over the tables warms
+// the solver up
+template< typename SOLVER >
+double  countAllocations( SOLVER &solver, const Grade &g )
+{
+	sudoku::Table  out;
+	long  start = 0;
+
+	for( int pass = 0; pass != 2; ++pass )
+	{
+		start = allocations;
+		for( size_t i = 0; i != g.puzzles.size(); ++i )
+		{
+			solver.init( g.puzzles[i] );
+			if( solver.run() )
+			{
+				solver.extractTable(out);
+				solver.next();
+			}
+		}
+	}
+
+	return (double) (allocations - start) / g.puzzles.size();
+}
+
+// Prints the allocations of every engine, returns the number of engines
+// which allocate after the warm-up
+int  checkAllocations( const Grade &g )
+{
+	sudoku::Solver  cube, rules;
+	sudoku::BitSolver  bits;
+	sudoku::DlxSolver  dlx;
+	for( int r = 0; r != sudoku::Solver::RULES; ++r )
+		rules.enable( (sudoku::Solver::Rule) r );
+
+	const char  *names[4] = { "cube", "cube+rules", "bits", "dlx" };
+	const double  counts[4] = { countAllocations( cube, g ), countAllocations( rules, g ), countAllocations( bits, g ),
+		countAllocations( dlx, g ) };
+
+	int  failed = 0;
+	std::cout << "Allocations per table after the warm-up:" << std::endl;
+	for( int e = 0; e != 4; ++e )
+	{
+		std::cout << std::left << std::setw(34) << names[e] << std::right << std::setw(12) << counts[e];
+		if( counts[e] != 0.0 )
+		{
+			std::cout << "  ALLOCATES";
+			++failed;
+		}
+		std::cout << std::endl;
+	}
+
+	return failed;
+}
+
+
+//NOTE: Results
+// Every repeat of a benchmark gives one sample, its time per operation. The
+// results are the median and the maximum of the samples, and their standard
+// deviation. A sample is already the mean of a whole grade, and there are
+// too few repeats for a percentile above the median to be other than the
+// maximum, so the slowest repeat is reported as such.
+struct Result
+{
+	double  median;
+	double  max;
+	double  stddev;
+	long  operations;
+
+	inline Result() : median(0.0), max(0.0), stddev(0.0), operations(0)  {}
+};
+
+typedef std::map<std::string, Result>  Results;
+
+Result  summarize( std::vector<double> samples, const long operations )
+{
+	Result  r;
+	r.operations = operations;
+	if( samples.empty() )
+		return r;
+
+	std::sort( samples.begin(), samples.end() );
+
+	const size_t  n = samples.size();
+	r.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+	r.max = samples[n - 1];
+
+	double  mean = 0.0;
+	for( size_t i = 0; i != n; ++i )
+		mean += samples[i];
+	mean /= n;
+
+	for( size_t i = 0; i != n; ++i )
+		r.stddev += (samples[i] - mean) * (samples[i] - mean);
+	r.stddev = (n > 1) ? std::sqrt( r.stddev / (n - 1) ) : 0.0;
+
+	return r;
+}
+
+// One line per benchmark: name, median, maximum and standard deviation in
+// nanoseconds per operation, and the operations of a sample
+void  writeResults( std::ostream &os, const Results &results )
+{
+	os << "# sdk-bench results: name median_ns max_ns stddev_ns operations" << std::endl;
+	for( Results::const_iterator it = results.begin(); it != results.end(); ++it )
+		os << it->first << '\t' << it->second.median << '\t' << it->second.max << '\t'
+			<< it->second.stddev << '\t' << it->second.operations << std::endl;
+}
+
+bool  readResults( const char *path, Results &results )
+{
+	std::ifstream  in(path);
+	if( !in )
+		return false;
+
+	std::string  line;
+	while( std::getline( in, line ) )
+	{
+		if( line.empty() || line[0] == '#' )
+			continue;
+
+		std::istringstream  fields(line);
+		std::string  name;
+		Result  r;
+		if( fields >> name >> r.median >> r.max >> r.stddev >> r.operations )
+			results[name] = r;
+	}
+
+	return true;
+}
+
+
+struct Options
+{
+	size_t  count;
+	int  repeats;
+	uint64_t  seed;
+	const char  *input;
+	const char  *filter;
+	const char  *output;
+	const char  *baseline;
+	double  threshold;
+	bool  allocations;
+
+	inline Options() : count(500), repeats(15), seed(2012), input(0), filter(0), output(0), baseline(0), threshold(5.0),
+		allocations(false)  {}
+};
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-n COUNT] [-r REPEATS] [-s SEED] [-i FILE] [-f FILTER] [-o FILE] [-b FILE] [-t PERCENT] [-a]" << std::endl
+		<< "  -n COUNT    puzzles per grade (default: 500)" << std::endl
+		<< "  -r REPEATS  samples per benchmark (default: 15)" << std::endl
+		<< "  -s SEED     seed of the generated corpus (default: 2012)" << std::endl
+		<< "  -i FILE     grade the puzzles of a one-line corpus instead of generating them" << std::endl
+		<< "  -f FILTER   run only the benchmarks whose name contains FILTER" << std::endl
+		<< "  -o FILE     write the results to FILE, to be used as a baseline later" << std::endl
+		<< "  -b FILE     compare the results with a baseline, the exit status is 1 if" << std::endl
+		<< "              a median is slower than the baseline by more than the threshold" << std::endl
+		<< "  -t PERCENT  regression threshold of -b (default: 5)" << std::endl
+		<< "  -a          instead of the benchmarks, check that the solvers do not allocate" << std::endl
+		<< "              once warmed up, the exit status is 1 if one does" << std::endl;
+}
+
+int  main( int argc, char *argv[] )
+{
+	Options  options;
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "n:r:s:i:f:o:b:t:ah")) != -1 )
+		switch( opt )
+		{
+		case 'n':
+			options.count = atol(optarg);
+			break;
+
+		case 'r':
+			options.repeats = std::max( 1, atoi(optarg) );
+			break;
+
+		case 's':
+			options.seed = strtoull( optarg, 0, 10 );
+			break;
+
+		case 'i':
+			options.input = optarg;
+			break;
+
+		case 'f':
+			options.filter = optarg;
+			break;
+
+		case 'o':
+			options.output = optarg;
+			break;
+
+		case 'b':
+			options.baseline = optarg;
+			break;
+
+		case 't':
+			options.threshold = atof(optarg);
+			break;
+
+		case 'a':
+			options.allocations = true;
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	Results  baseline;
+	if( options.baseline && !readResults( options.baseline, baseline ) )
+	{
+		std::cerr << "Failed to read the baseline '" << options.baseline << "'" << std::endl;
+		return -1;
+	}
+
+	Corpus  corpus;
+	if( options.input )
+	{
+		if( !corpus.read( options.input, options.count ) )
+		{
+			std::cerr << "Failed to map the input '" << options.input << "'" << std::endl;
+			return -1;
+		}
+	}
+	else
+		corpus.generate( options.seed, options.count );
+
+	std::cout << "Corpus:";
+	for( size_t g = 0; g != corpus.grades.size(); ++g )
+		std::cout << " " << corpus.grades[g].puzzles.size() << " " << corpus.grades[g].name;
+	std::cout << std::endl << std::endl;
+
+	if( options.allocations )
+		return checkAllocations( corpus.all ) ? 1 : 0;
+
+	std::vector<Benchmark*>  benchmarks;
+	benchmarks.push_back( new MarkOccupied );
+	benchmarks.push_back( new DeterministicMove );
+	benchmarks.push_back( new Init );
+	benchmarks.push_back( new Check );
+	benchmarks.push_back( new Parse );
+	benchmarks.push_back( new Format );
+	benchmarks.push_back( new Solve<sudoku::Solver>("solve.cube") );
+	for( int r = 0; r <= sudoku::Solver::RULES; ++r )
+		benchmarks.push_back( new SolveRules(r) );
+	benchmarks.push_back( new Solve<sudoku::BitSolver>("solve.bits") );
+	benchmarks.push_back( new Solve<sudoku::TieredSolver>("solve.tiered") );
+	benchmarks.push_back( new Solve<sudoku::DlxSolver>("solve.dlx") );
+	benchmarks.push_back( new Solve<sudoku::LearningSolver>("solve.learning") );
+	benchmarks.push_back( new SolveBatch );
+
+	std::cout << std::left << std::setw(34) << "benchmark" << std::right
+		<< std::setw(12) << "median ns" << std::setw(12) << "max ns" << std::setw(10) << "stddev %";
+	if( options.baseline )
+		std::cout << std::setw(12) << "baseline" << std::setw(10) << "change %";
+	std::cout << std::endl << std::fixed << std::setprecision(1);
+
+	Results  results;
+	int  regressions = 0;
+	for( size_t b = 0; b != benchmarks.size(); ++b )
+		for( size_t g = 0; g != corpus.grades.size() + 1; ++g )
+		{
+			Benchmark  &benchmark = *benchmarks[b];
+			const bool  all = g == corpus.grades.size();
+			if( benchmark.graded() == all )
+				continue;
+
+			const Grade  &grade = all ? corpus.all : corpus.grades[g];
+			const std::string  name = std::string(grade.name) + "/" + benchmark.name();
+			if( grade.puzzles.empty() || (options.filter && name.find(options.filter) == std::string::npos) )
+				continue;
+
+			const long  operations = (long) grade.puzzles.size() * benchmark.operations();
+
+			//NOTE: the first run only warms up the caches and the branch predictors
+			benchmark.run(grade);
+
+			std::vector<double>  samples;
+			for( int r = 0; r != options.repeats; ++r )
+				samples.push_back( benchmark.run(grade) / operations );
+
+			const Result  &result = results[name] = summarize( samples, operations );
+
+			std::cout << std::left << std::setw(34) << name << std::right
+				<< std::setw(12) << result.median << std::setw(12) << result.max
+				<< std::setw(10) << 100.0 * result.stddev / result.median;
+
+			Results::const_iterator  base = baseline.find(name);
+			if( base != baseline.end() )
+			{
+				const double  change = 100.0 * (result.median / base->second.median - 1.0);
+				std::cout << std::setw(12) << base->second.median << std::setw(10) << std::showpos << change << std::noshowpos;
+				if( change > options.threshold )
+				{
+					std::cout << "  REGRESSION";
+					++regressions;
+				}
+			}
+
+			const std::string  note = benchmark.note();
+			if( !note.empty() )
+				std::cout << "  " << note;
+
+			std::cout << std::endl;
+		}
+
+	for( size_t b = 0; b != benchmarks.size(); ++b )
+		delete benchmarks[b];
+
+	if( options.output )
+	{
+		std::ofstream  out( options.output );
+		writeResults( out, results );
+		if( !out )
+		{
+			std::cerr << "Failed to write the results to '" << options.output << "'" << std::endl;
+			return -1;
+		}
+	}
+
+	if( options.baseline )
+		std::cout << std::endl << regressions << " regression(s) above " << options.threshold << "%" << std::endl;
+
+	return regressions ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * sdk-convert app.
+ * Converts sudoku corpora between the text formats and the packed format.
+ */ 
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <unistd.h>
+#include "sudoku/table.h"
+#include "sudoku/reader.h"
+#include "sudoku/packed.h"
+
+
+// Writes the tables in the requested output format
+class Output
+{
+public:
+	Output( std::ostream &os, const bool packed ) : _os(os), _packer(0), _count(0), _failed(0)
+	{
+		if( packed )
+			_packer = new sudoku::PackedWriter(os);
+	}
+
+	~Output()
+	{
+		delete _packer;
+	}
+
+	void  write( const sudoku::Table &t )
+	{
+		if( _packer )
+		{
+			if( !_packer->write(t) )
+			{
+				++_failed;
+				return;
+			}
+		}
+		else
+			_os << sudoku::LineTable(t) << '\n';
+
+		++_count;
+	}
+
+	inline long  count() const {
+		return _count;
+	}
+
+	inline long  failed() const {
+		return _failed;
+	}
+
+private:
+	std::ostream  &_os;
+	sudoku::PackedWriter  *_packer;
+	long  _count;
+	long  _failed;
+};
+
+
+// A sample list, like samples/test.set: paths of table files
+long  convert_list( std::istream &list, Output &out )
+{
+	long  skipped = 0;
+	sudoku::Table  table;
+
+	while( !list.eof() )
+	{
+		char  buff[256];
+		list.getline(buff, 256);
+
+		if( buff[0] == '#' || buff[0] == 0 )
+			continue;
+
+		std::ifstream  sample(buff);
+		if( !sample || !(sample >> table) )
+		{
+			std::cerr << "Failed to read sample file '" << buff << "'" << std::endl;
+			++skipped;
+			continue;
+		}
+
+		out.write(table);
+	}
+
+	return skipped;
+}
+
+long  convert_corpus( sudoku::MappedCorpus &corpus, Output &out )
+{
+	sudoku::Table  table;
+	while( corpus.next(table) )
+		out.write(table);
+
+	return corpus.skipped();
+}
+
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-f list|tables|lines|packed] [-t packed|lines] [input] > output" << std::endl
+		<< "  -f FORMAT  format of the input (default: list)" << std::endl
+		<< "             list: paths of table files, as in samples/test.set" << std::endl
+		<< "             tables: tables in the table format, one after the other" << std::endl
+		<< "             lines: one table per line" << std::endl
+		<< "             packed: the packed binary format" << std::endl
+		<< "  -t FORMAT  format of the output (default: packed)" << std::endl
+		<< "  input      read from this file instead of the standard input" << std::endl;
+}
+
+int  main( int argc, char *argv[] )
+{
+	const char  *from = "list";
+	const char  *to = "packed";
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "f:t:h")) != -1 )
+		switch( opt )
+		{
+		case 'f':
+			from = optarg;
+			break;
+
+		case 't':
+			to = optarg;
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	const char  *input = (optind < argc) ? argv[optind] : 0;
+
+	if( strcmp(to, "packed") != 0 && strcmp(to, "lines") != 0 )
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	std::ios::sync_with_stdio(false);
+	Output  out( std::cout, strcmp(to, "packed") == 0 );
+	long  skipped;
+
+	if( strcmp(from, "list") == 0 )
+	{
+		std::ifstream  file;
+		if( input )
+			file.open(input);
+
+		if( input && !file )
+		{
+			std::cerr << "Failed to open input file '" << input << "'" << std::endl;
+			return -1;
+		}
+
+		skipped = convert_list( input ? file : std::cin, out );
+	}
+	else
+	{
+		sudoku::MappedCorpus::Format  format;
+		if( strcmp(from, "tables") == 0 )
+			format = sudoku::MappedCorpus::TABLES;
+		else if( strcmp(from, "lines") == 0 )
+			format = sudoku::MappedCorpus::LINES;
+		else if( strcmp(from, "packed") == 0 )
+			format = sudoku::MappedCorpus::PACKED;
+		else
+		{
+			usage(argv[0]);
+			return -1;
+		}
+
+		sudoku::MappedCorpus  corpus( input, format );
+		if( !corpus.isOpen() )
+		{
+			std::cerr << "Failed to map the input, it must be a regular file in the given format" << std::endl;
+			return -1;
+		}
+
+		skipped = convert_corpus( corpus, out );
+	}
+
+	std::cout.flush();
+	std::cerr << "Converted " << out.count() << " tables, skipped " << skipped + out.failed() << std::endl;
+
+	return 0;
+}
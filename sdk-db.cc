@@ -0,0 +1,116 @@
+/*
+ * sdk-db app.
+ * Builds the solution database of sdk-batch and sdk-demo (see -D).
+ */
+
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include "sudoku/table.h"
+#include "sudoku/reader.h"
+#include "sudoku/database.h"
+
+
+// The n-th table of the corpus is paired with the n-th line of the
+// solutions, as sdk-batch writes them in corpus mode (the counts of -n
+// after the solutions are ignored)
+int  add_pairs( const char *puzzles, const char *solutions, const sudoku::MappedCorpus::Format format,
+		sudoku::DatabaseWriter &writer, long &added, long &skipped )
+{
+	sudoku::MappedCorpus  corpus( puzzles, format );
+	sudoku::MappedCorpus  solved( solutions, sudoku::MappedCorpus::LINES );
+	if( !corpus.isOpen() || !solved.isOpen() )
+	{
+		std::cerr << "Failed to map '" << puzzles << "' or '" << solutions << "', they must be regular files" << std::endl;
+		return -1;
+	}
+
+	sudoku::Table  puzzle, solution;
+	while( corpus.next(puzzle) )
+	{
+		if( !solved.next(solution) )
+		{
+			std::cerr << "The solutions '" << solutions << "' end before the puzzles '" << puzzles << "'" << std::endl;
+			return -1;
+		}
+
+		//NOTE: the unsolvable tables are written unchanged by sdk-batch
+		if( writer.add( puzzle, solution ) )
+			++added;
+		else
+			++skipped;
+	}
+
+	return 0;
+}
+
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-p] -o DATABASE PUZZLES SOLUTIONS [PUZZLES SOLUTIONS]..." << std::endl
+		<< "  -o FILE    the database, the records of the pairs are added to the ones" << std::endl
+		<< "             already in it (created if missing), and it is rewritten sorted," << std::endl
+		<< "             with every puzzle once" << std::endl
+		<< "  -p         the puzzles are packed corpora (see sdk-convert), not lines" << std::endl
+		<< "  PUZZLES    a corpus of one-line tables" << std::endl
+		<< "  SOLUTIONS  the output of sdk-batch for the corpus, the pairs whose solution" << std::endl
+		<< "             is incomplete or wrong are skipped" << std::endl;
+}
+
+int  main( int argc, char *argv[] )
+{
+	const char  *path = 0;
+	sudoku::MappedCorpus::Format  format = sudoku::MappedCorpus::LINES;
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "o:ph")) != -1 )
+		switch( opt )
+		{
+		case 'o':
+			path = optarg;
+			break;
+
+		case 'p':
+			format = sudoku::MappedCorpus::PACKED;
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	if( !path || (argc - optind) % 2 != 0 )
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	sudoku::DatabaseWriter  writer;
+
+	//NOTE: the database is rebuilt, so a missing one is not an error
+	if( access( path, F_OK ) == 0 )
+	{
+		sudoku::SolutionDatabase  database(path);
+		if( !database.isOpen() )
+		{
+			std::cerr << "The database '" << path << "' is malformed" << std::endl;
+			return -1;
+		}
+		writer.add(database);
+	}
+
+	long  added = 0, skipped = 0;
+	for( int i = optind; i != argc; i += 2 )
+		if( add_pairs( argv[i], argv[i + 1], format, writer, added, skipped ) != 0 )
+			return -1;
+
+	const long  records = writer.write(path);
+	if( records < 0 )
+	{
+		std::cerr << "Failed to write the database '" << path << "'" << std::endl;
+		return -1;
+	}
+
+	std::cerr << "Added " << added << " tables, skipped " << skipped << ", the database holds " << records << std::endl;
+	return 0;
+}
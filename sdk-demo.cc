@@ -4,43 +4,166 @@
  */ 
 
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 #include "sudoku/table.h"
 #include "sudoku/solver.h"
+#include "sudoku/bitsolver.h"
+#include "sudoku/dlx.h"
+#include "sudoku/parallel.h"
+#include "sudoku/database.h"
 
 
-int  main( int argc, char *argv[] )
+// The database holds 9x9 tables only
+template< typename TABLE >
+inline bool  lookup( const sudoku::SolutionDatabase&, TABLE& )
+{
+	return false;
+}
+
+inline bool  lookup( const sudoku::SolutionDatabase &database, sudoku::Table &table )
+{
+	return database.find( table, table );
+}
+
+
+template< typename SOLVER >
+int  demo( SOLVER &solver, const sudoku::SolutionDatabase &database )
 {
-	sudoku::Table  table;
+	typedef typename SOLVER::TableType  Table;
+
+	Table  table;
 	std::cin >> table;
 
-	if( table.check() == sudoku::Table::INVALID )
+	if( table.check() == Table::INVALID )
 		std::cout << "The given table is invalid." << std::endl;
 
-	sudoku::Solver  solver;
 	bool  solved;
-	
-	try
+	if( database.isOpen() && lookup( database, table ) )
 	{
-		solver.init(table);
-		solved = solver.run();
+		solved = true;
+		std::cout << "Table found in the database." << std::endl;
 	}
-	catch( const sudoku::Solver::InconsistencyError &e )
+	else
 	{
-		std::cout << e.what() << std::endl;
-		return -1;
-	}
+		solver.init(table);
+		solved = solver.run();
 
-	solver.extractTable(table);
+		solver.extractTable(table);
+	}
 
 	if( solved )
 		std::cout << "Table solved." << std::endl << "Checking consistecy...  " << std::flush <<
-			((table.check() == sudoku::Table::CORRECT) ? "OK" : "FAILED") << std::endl;
+			((table.check() == Table::CORRECT) ? "OK" : "FAILED") << std::endl;
 	else
 		std::cout << "Table could not be solved." << std::endl;
 
-	std::cout << sudoku::FormatedTable(table) << std::endl;
+	std::cout << sudoku::BasicFormatedTable<Table::Box>(table) << std::endl;
 
 
 	return 0;
 }
 
+template< typename SOLVER >
+inline int  demo( const sudoku::SolutionDatabase &database )
+{
+	SOLVER  solver;
+	return demo( solver, database );
+}
+
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-e cube|bits|dlx] [-s SIZE] [-j N] [-D FILE] < table" << std::endl
+		<< "  -e ENGINE  solver engine of a 9x9 table (default: cube), the other" << std::endl
+		<< "             sizes are solved by the bits engine" << std::endl
+		<< "  -s SIZE    side of the table: 4, 9, 16 or 25 (default: 9)" << std::endl
+		<< "  -j N       split the search of a 9x9 table over N threads (default: 1)," << std::endl
+		<< "             with the cube engine" << std::endl
+		<< "  -D FILE    look the 9x9 table up in a solution database (see sdk-db) first" << std::endl;
+}
+
+int  main( int argc, char *argv[] )
+{
+	const char  *engine = "cube";
+	int  size = 9;
+	int  jobs = 1;
+	const char  *path = 0;
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "e:s:j:D:h")) != -1 )
+		switch( opt )
+		{
+		case 'e':
+			engine = optarg;
+			break;
+
+		case 's':
+			size = atoi(optarg);
+			break;
+
+		case 'j':
+			jobs = atoi(optarg);
+			break;
+
+		case 'D':
+			path = optarg;
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	if( strcmp(engine, "cube") != 0 && strcmp(engine, "bits") != 0 && strcmp(engine, "dlx") != 0 )
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	const sudoku::SolutionDatabase  database(path);
+	if( path && !database.isOpen() )
+	{
+		std::cout << "Failed to map the solution database '" << path << "'" << std::endl;
+		return -1;
+	}
+
+	//NOTE: the cube engine is built for 9x9 tables, the other sizes use the bitboard one
+	try
+	{
+		switch( size )
+		{
+		case 4:
+			return demo< sudoku::BasicBitSolver<2> >(database);
+
+		case 9:
+			if( strcmp(engine, "bits") == 0 )
+				return demo<sudoku::BitSolver>(database);
+			if( strcmp(engine, "dlx") == 0 )
+				return demo<sudoku::DlxSolver>(database);
+
+			if( jobs > 1 )
+			{
+				sudoku::ParallelSolver  solver(jobs);
+				return demo( solver, database );
+			}
+			return demo<sudoku::Solver>(database);
+
+		case 16:
+			return demo< sudoku::BasicBitSolver<4> >(database);
+
+		case 25:
+			return demo< sudoku::BasicBitSolver<5> >(database);
+
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	catch( const sudoku::Solver::InconsistencyError &e )
+	{
+		std::cout << e.what() << std::endl;
+		return -1;
+	}
+}
@@ -0,0 +1,357 @@
+/*
+ * sdk-gen app.
+ * Generates sudoku puzzles with a unique solution.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <stdint.h>
+#include <unistd.h>
+#include "sudoku/table.h"
+#include "sudoku/solver.h"
+#include "sudoku/bitsolver.h"
+#include "sudoku/workpool.h"
+#include "stopper.h"
+#include "random.h"
+
+
+//NOTE: Uniqueness check
+// The puzzle being cut has a known solution. After a given is removed, any
+// other solution must differ from it in the freed cell, so the puzzle stays
+// unique iff it has no solution with the removed value excluded from that
+// cell. So every removal is checked by a single run() on a search pruned by
+// the exclusion, instead of counting the solutions up to two. The check
+// still starts from init() on the puzzle, the solver keeps nothing of the
+// previous removal.
+template< typename SOLVER >
+bool  unique( SOLVER &solver, const sudoku::Table &puzzle, const int x, const int y, const sudoku::Table::Value v )
+{
+	solver.init(puzzle);
+	solver.exclude( x, y, v );
+	return !solver.run();
+}
+
+// A solved grid: the three boxes on the diagonal do not share a house, so
+// they are filled with random permutations, the solver does the rest
+template< typename SOLVER >
+void  randomGrid( SOLVER &solver, Random &random, sudoku::Table &grid )
+{
+	sudoku::Table  seed;
+	for( int b = 0; b != 3; ++b )
+	{
+		int  digits[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		random.shuffle( digits, 9 );
+		for( int i = 0; i != 9; ++i )
+			seed( b * 3 + i % 3, b * 3 + i / 3 ) = digits[i];
+	}
+
+	solver.init(seed);
+	solver.run();
+	solver.extractTable(grid);
+}
+
+
+// The difficulty bands are the grades of sdk-bench: the decisions the
+// bitboard solver needs
+struct Band
+{
+	const char  *name;
+	int  min_decisions, max_decisions;
+};
+
+const Band  bands[] = {
+	{ "easy", 0, 0 },
+	{ "medium", 1, 9 },
+	{ "hard", 10, -1 },
+};
+
+struct Totals
+{
+	long  puzzles;
+	long  rejected;
+	long  givens;
+
+	long  failed; // puzzles given up, none of their grids was in the band
+
+	inline Totals() : puzzles(0), rejected(0), givens(0), failed(0)  {}
+};
+
+struct Options
+{
+	const char  *engine;
+	long  count;
+	int  jobs;
+	uint64_t  seed;
+	int  givens;
+	const Band  *band;
+
+	inline Options() : engine("cube"), count(1000), jobs(1), seed(2012), givens(17), band(0)  {}
+};
+
+
+// Every item is a puzzle, made by its own generator, so the output depends
+// only on the seed, not on the number of workers
+template< typename SOLVER >
+class GeneratorJob : public sudoku::WorkPool::Job
+{
+public:
+	std::vector<sudoku::Table>  puzzles;
+	long  first;
+
+	inline  GeneratorJob( const int workers, const Options &options )
+		: first(0), _workers(workers), _options(options)  {}
+
+	//NOTE: a band may be out of reach (e.g. hard puzzles of many givens), so
+	// a puzzle is given up after MAX_ATTEMPTS grids
+	enum {
+		MAX_ATTEMPTS = 1000,
+	};
+
+	virtual void  process( const int worker, const long item )
+	{
+		Worker  &w = _workers[worker];
+		Random  random( _options.seed, first + item );
+
+		for( int attempt = 0; attempt != MAX_ATTEMPTS; ++attempt )
+		{
+			w.givens += generate( w.solver, random, puzzles[item] );
+			if( inBand( w.grader, puzzles[item] ) )
+			{
+				++w.puzzles;
+				return;
+			}
+			++w.rejected;
+		}
+
+		++w.failed;
+	}
+
+	void  add( Totals &totals ) const
+	{
+		for( size_t i = 0; i != _workers.size(); ++i )
+		{
+			totals.puzzles += _workers[i].puzzles;
+			totals.rejected += _workers[i].rejected;
+			totals.givens += _workers[i].givens;
+			totals.failed += _workers[i].failed;
+		}
+	}
+
+	long  failed() const
+	{
+		long  failed = 0;
+		for( size_t i = 0; i != _workers.size(); ++i )
+			failed += _workers[i].failed;
+		return failed;
+	}
+
+	inline long  items( const size_t count )
+	{
+		puzzles.resize(count);
+		return count;
+	}
+
+private:
+	struct Worker
+	{
+		SOLVER  solver;
+		sudoku::BitSolver  grader;
+		long  puzzles;
+		long  rejected;
+		long  givens; // of the accepted and the rejected ones
+		long  failed;
+
+		char  padding[64];
+
+		inline Worker() : puzzles(0), rejected(0), givens(0), failed(0)  {}
+	};
+
+	std::vector<Worker>  _workers;
+	const Options  &_options;
+
+	// Removes the givens of a random grid in a random order, the ones whose
+	// removal would leave more solutions are kept, returns their count
+	int  generate( SOLVER &solver, Random &random, sudoku::Table &puzzle )
+	{
+		randomGrid( solver, random, puzzle );
+
+		int  cells[81];
+		for( int c = 0; c != 81; ++c )
+			cells[c] = c;
+		random.shuffle( cells, 81 );
+
+		int  givens = 81;
+		for( int i = 0; i != 81 && givens > _options.givens; ++i )
+		{
+			const int  x = cells[i] % 9, y = cells[i] / 9;
+			const sudoku::Table::Value  v = puzzle(x,y);
+
+			puzzle(x,y) = sudoku::Table::empty;
+			if( unique( solver, puzzle, x, y, v ) )
+				--givens;
+			else
+				puzzle(x,y) = v;
+		}
+
+		return givens;
+	}
+
+	bool  inBand( sudoku::BitSolver &grader, const sudoku::Table &puzzle ) const
+	{
+		if( !_options.band )
+			return true;
+
+		grader.init(puzzle);
+		grader.run();
+
+		const int  decisions = grader.decisions();
+		return decisions >= _options.band->min_decisions
+			&& (_options.band->max_decisions == -1 || decisions <= _options.band->max_decisions);
+	}
+};
+
+
+// Generates the puzzles in blocks, every block is written as soon as it is
+// done, so the output streams even when the count is unlimited. Stops at
+// the first block with a puzzle given up, without writing it.
+template< typename SOLVER >
+void  generate( const Options &options, std::ostream &out, Totals &totals )
+{
+	const long  block = 256;
+
+	sudoku::WorkPool  pool( options.jobs );
+	GeneratorJob<SOLVER>  job( pool.workers(), options );
+
+	long  generated = 0;
+	while( options.count == 0 || generated != options.count )
+	{
+		const long  count = (options.count == 0) ? block : std::min( block, options.count - generated );
+
+		job.first = generated;
+		pool.run( job, job.items(count) );
+
+		if( job.failed() )
+			break;
+
+		for( long i = 0; i != count; ++i )
+			out << sudoku::LineTable( job.puzzles[i] ) << '\n';
+		out.flush();
+
+		generated += count;
+	}
+
+	job.add(totals);
+}
+
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-e cube|bits] [-n COUNT] [-j N] [-s SEED] [-g GIVENS] [-d BAND]" << std::endl
+		<< "  -e ENGINE  solver engine of the uniqueness checks (default: cube)" << std::endl
+		<< "  -n COUNT   puzzles to generate, 0 for no end (default: 1000)" << std::endl
+		<< "  -j N       generate on N threads (default: 1)" << std::endl
+		<< "  -s SEED    seed of the random grids (default: 2012)" << std::endl
+		<< "  -g GIVENS  stop removing the givens at GIVENS (default: 17)" << std::endl
+		<< "  -d BAND    keep only the puzzles of a difficulty band: easy, medium or" << std::endl
+		<< "             hard, by the decisions of the bits engine (as in sdk-bench)" << std::endl;
+}
+
+int  main( int argc, char *argv[] )
+{
+	Options  options;
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "e:n:j:s:g:d:h")) != -1 )
+		switch( opt )
+		{
+		case 'e':
+			options.engine = optarg;
+			break;
+
+		case 'n':
+			options.count = atol(optarg);
+			if( options.count < 0 )
+			{
+				std::cerr << "The count must not be negative" << std::endl;
+				return -1;
+			}
+			break;
+
+		case 'j':
+			options.jobs = atoi(optarg);
+			if( options.jobs < 1 )
+			{
+				std::cerr << "The number of threads must be at least 1" << std::endl;
+				return -1;
+			}
+			break;
+
+		case 's':
+			options.seed = strtoull( optarg, 0, 10 );
+			break;
+
+		case 'g':
+			options.givens = atoi(optarg);
+			if( options.givens < 0 || options.givens > 81 )
+			{
+				std::cerr << "The givens must be between 0 and 81" << std::endl;
+				return -1;
+			}
+			break;
+
+		case 'd':
+			for( size_t b = 0; b != sizeof(bands) / sizeof(bands[0]); ++b )
+				if( strcmp( optarg, bands[b].name ) == 0 )
+					options.band = &bands[b];
+
+			if( !options.band )
+			{
+				usage(argv[0]);
+				return -1;
+			}
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	std::ios::sync_with_stdio(false);
+
+	Stopper  stopper;
+
+	Totals  totals;
+	if( strcmp(options.engine, "cube") == 0 )
+		generate<sudoku::Solver>( options, std::cout, totals );
+	else if( strcmp(options.engine, "bits") == 0 )
+		generate<sudoku::BitSolver>( options, std::cout, totals );
+	else
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	const double  elapsed = stopper.elapsed();
+
+	if( totals.failed )
+	{
+		std::cerr << "No " << options.band->name << " puzzle was found in " << GeneratorJob<sudoku::Solver>::MAX_ATTEMPTS
+			<< " grids cut to " << options.givens << " givens, try fewer givens or another band" << std::endl;
+		return -1;
+	}
+
+	// The standard output carries the puzzles
+	std::cerr << std::endl << "Finished generating sudoku puzzles (" << options.engine << " engine)" << std::endl << std::endl
+		<< "Puzzles:" << std::setw(27) << totals.puzzles << std::endl;
+	if( options.band )
+		std::cerr << "Rejected (not " << options.band->name << "):" << std::setw(19 - strlen(options.band->name)) << totals.rejected << std::endl;
+	std::cerr << "Average givens:" << std::setw(20) << (double) totals.givens / (totals.puzzles + totals.rejected) << std::endl
+		<< "Total (sec):" << std::setw(23) << elapsed << std::endl
+		<< "Puzzles/sec:" << std::setw(23) << totals.puzzles / elapsed << std::endl;
+
+	return 0;
+}
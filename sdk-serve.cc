@@ -0,0 +1,387 @@
+/*
+ * sdk-serve app.
+ * Keeps the solvers resident and answers the puzzles of the clients.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <exception>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "sudoku/table.h"
+#include "sudoku/solver.h"
+#include "sudoku/bitsolver.h"
+#include "sudoku/dlx.h"
+#include "stopper.h"
+
+
+//NOTE: Protocol
+// A request is a line with a table in the one-line format, the reply is a
+// line too: the solution in the same format, "solved" or "unsolvable", the
+// decisions, the backsteps and the solving time in microseconds, or
+// "error" and the reason. Every nonempty line gets a reply, in order, so a
+// client may send a whole batch (or keep sending) without waiting. The
+// lines read together are answered in one write, by a solver borrowed for
+// GROUP lines at a time. A line longer than MAX_LINE bytes is not kept, it
+// gets "error line too long" and is dropped up to its line break.
+enum {
+	MAX_LINE = 1024,
+	GROUP = 64,
+};
+
+
+// The solvers are made, and warmed up by a solve, once. A connection
+// borrows one for a group of the lines it has read, so the number of solvers bounds
+// the solves running at once, not the number of clients.
+template< typename SOLVER >
+class SolverPool
+{
+public:
+	explicit SolverPool( const int size ) : _solvers( size < 1 ? 1 : size )
+	{
+		pthread_mutex_init( &_lock, 0 );
+		pthread_cond_init( &_released, 0 );
+
+		sudoku::Table  empty;
+		for( size_t i = 0; i != _solvers.size(); ++i )
+		{
+			_solvers[i].init(empty);
+			_solvers[i].run();
+			_free.push_back( &_solvers[i] );
+		}
+	}
+
+	~SolverPool()
+	{
+		pthread_cond_destroy( &_released );
+		pthread_mutex_destroy( &_lock );
+	}
+
+	SOLVER&  acquire()
+	{
+		pthread_mutex_lock( &_lock );
+		while( _free.empty() )
+			pthread_cond_wait( &_released, &_lock );
+
+		SOLVER  &solver = *_free.back();
+		_free.pop_back();
+
+		pthread_mutex_unlock( &_lock );
+		return solver;
+	}
+
+	void  release( SOLVER &solver )
+	{
+		pthread_mutex_lock( &_lock );
+		_free.push_back( &solver );
+		pthread_cond_signal( &_released );
+		pthread_mutex_unlock( &_lock );
+	}
+
+private:
+	std::vector<SOLVER>  _solvers;
+	std::vector<SOLVER*>  _free;
+	pthread_mutex_t  _lock;
+	pthread_cond_t  _released;
+
+	SolverPool( const SolverPool& );
+	SolverPool&  operator= ( const SolverPool& );
+};
+
+
+template< typename SOLVER >
+void  answer( SOLVER &solver, const char *line, const size_t length, std::ostream &reply )
+{
+	sudoku::Table  table;
+	if( !sudoku::readLine( line, length, table ) )
+	{
+		reply << "error malformed table\n";
+		return;
+	}
+
+	try
+	{
+		Stopper  stopper;
+		solver.init(table);
+		const bool  solved = solver.run();
+		solver.extractTable(table);
+		const double  elapsed = stopper.elapsed();
+
+		reply << sudoku::LineTable(table) << ' ' << (solved ? "solved" : "unsolvable") << ' '
+			<< solver.decisions() << ' ' << solver.backsteps() << ' ' << (long) (elapsed * 1e6 + 0.5) << '\n';
+	}
+	catch( const std::exception &e )
+	{
+		reply << "error " << e.what() << '\n';
+	}
+}
+
+// Answers the complete lines of the buffer, returns the length answered
+template< typename SOLVER >
+size_t  answer_lines( SolverPool<SOLVER> &pool, const std::string &buffer, std::ostream &reply )
+{
+	size_t  begin = 0;
+	for( size_t eol = buffer.find('\n'); eol != std::string::npos; )
+	{
+		SOLVER  &solver = pool.acquire();
+
+		for( int lines = 0; lines != GROUP && eol != std::string::npos; ++lines )
+		{
+			size_t  length = eol - begin;
+			if( length > MAX_LINE )
+				reply << "error line too long\n";
+			else
+			{
+				if( length && buffer[begin + length - 1] == '\r' )
+					--length;
+
+				if( length )
+					answer( solver, buffer.data() + begin, length, reply );
+			}
+
+			begin = eol + 1;
+			eol = buffer.find( '\n', begin );
+		}
+
+		pool.release(solver);
+	}
+
+	return begin;
+}
+
+bool  write_all( const int fd, const std::string &data )
+{
+	for( size_t done = 0; done != data.size(); )
+	{
+		const ssize_t  n = write( fd, data.data() + done, data.size() - done );
+		if( n < 0 && errno == EINTR )
+			continue;
+		if( n <= 0 )
+			return false;
+		done += n;
+	}
+
+	return true;
+}
+
+// Serves the requests read from in until the end of the stream
+template< typename SOLVER >
+void  serve( SolverPool<SOLVER> &pool, const int in, const int out )
+{
+	std::string  buffer; // the line not complete yet
+	bool  dropping = false; // the rest of a line too long
+	char  chunk[65536];
+
+	for( ;; )
+	{
+		const ssize_t  n = read( in, chunk, sizeof(chunk) );
+		if( n < 0 && errno == EINTR )
+			continue;
+
+		//NOTE: a last line without a line break is answered too
+		if( n <= 0 )
+		{
+			if( !buffer.empty() )
+			{
+				std::ostringstream  reply;
+				buffer += '\n';
+				answer_lines( pool, buffer, reply );
+				write_all( out, reply.str() );
+			}
+			return;
+		}
+
+		const char  *data = chunk;
+		if( dropping )
+		{
+			data = (const char*) memchr( chunk, '\n', n );
+			if( !data )
+				continue;
+
+			dropping = false;
+			++data;
+		}
+
+		std::ostringstream  reply;
+		buffer.append( data, chunk + n - data );
+		buffer.erase( 0, answer_lines( pool, buffer, reply ) );
+
+		//NOTE: so the buffer never holds more than a line and a read
+		if( buffer.size() > MAX_LINE )
+		{
+			reply << "error line too long\n";
+			buffer.clear();
+			dropping = true;
+		}
+
+		const std::string  replies = reply.str();
+		if( !replies.empty() && !write_all( out, replies ) )
+			return;
+	}
+}
+
+
+template< typename SOLVER >
+struct Connection
+{
+	SolverPool<SOLVER>  *pool;
+	int  socket;
+};
+
+template< typename SOLVER >
+void*  connection( void *data )
+{
+	Connection<SOLVER>  *c = (Connection<SOLVER>*) data;
+	serve( *c->pool, c->socket, c->socket );
+
+	close( c->socket );
+	delete c;
+	return 0;
+}
+
+const char  *socket_path = 0;
+
+extern "C" void  stop( int )
+{
+	if( socket_path )
+		unlink( socket_path );
+	_exit(0);
+}
+
+// Every client gets a thread of its own, they share the solvers
+template< typename SOLVER >
+int  listen_on( const char *path, SolverPool<SOLVER> &pool )
+{
+	sockaddr_un  address;
+	if( strlen(path) >= sizeof(address.sun_path) )
+	{
+		std::cerr << "The socket path '" << path << "' is too long" << std::endl;
+		return -1;
+	}
+
+	memset( &address, 0, sizeof(address) );
+	address.sun_family = AF_UNIX;
+	strcpy( address.sun_path, path );
+
+	const int  server = socket( AF_UNIX, SOCK_STREAM, 0 );
+	unlink(path);
+	if( server == -1 || bind( server, (sockaddr*) &address, sizeof(address) ) != 0 || listen( server, 64 ) != 0 )
+	{
+		std::cerr << "Failed to listen on '" << path << "': " << strerror(errno) << std::endl;
+		return -1;
+	}
+
+	socket_path = path;
+	signal( SIGINT, stop );
+	signal( SIGTERM, stop );
+
+	std::cerr << "Listening on '" << path << "'" << std::endl;
+
+	for( ;; )
+	{
+		const int  client = accept( server, 0, 0 );
+		if( client == -1 )
+		{
+			if( errno == EINTR || errno == ECONNABORTED )
+				continue;
+
+			std::cerr << "Failed to accept a client: " << strerror(errno) << std::endl;
+			return -1;
+		}
+
+		Connection<SOLVER>  *c = new Connection<SOLVER>();
+		c->pool = &pool;
+		c->socket = client;
+
+		pthread_t  thread;
+		if( pthread_create( &thread, 0, connection<SOLVER>, c ) != 0 )
+		{
+			close(client);
+			delete c;
+			continue;
+		}
+		pthread_detach(thread);
+	}
+}
+
+template< typename SOLVER >
+int  run( const char *path, const int jobs )
+{
+	SolverPool<SOLVER>  pool(jobs);
+
+	if( !path )
+	{
+		serve( pool, STDIN_FILENO, STDOUT_FILENO );
+		return 0;
+	}
+
+	return listen_on( path, pool );
+}
+
+
+void  usage( const char *name )
+{
+	std::cout << "Usage: " << name << " [-e cube|bits|dlx] [-j N] [-u SOCKET]" << std::endl
+		<< "  -e ENGINE  solver engine (default: cube)" << std::endl
+		<< "  -j N       keep N solvers, the most tables solved at once (default: 1)" << std::endl
+		<< "  -u SOCKET  listen on this Unix domain socket, a thread per client," << std::endl
+		<< "             instead of serving the standard input and output" << std::endl
+		<< "Every line of one-line table gets a line of reply: the solution, solved" << std::endl
+		<< "or unsolvable, the decisions, the backsteps and the microseconds, or error" << std::endl
+		<< "and the reason." << std::endl;
+}
+
+int  main( int argc, char *argv[] )
+{
+	const char  *engine = "cube";
+	const char  *path = 0;
+	int  jobs = 1;
+	char  *end;
+
+	int  opt;
+	while( (opt = getopt(argc, argv, "e:j:u:h")) != -1 )
+		switch( opt )
+		{
+		case 'e':
+			engine = optarg;
+			break;
+
+		case 'j':
+			jobs = strtol( optarg, &end, 10 );
+			if( *end != '\0' || jobs < 1 )
+			{
+				std::cerr << "The number of solvers must be a number, at least 1" << std::endl;
+				return -1;
+			}
+			break;
+
+		case 'u':
+			path = optarg;
+			break;
+
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+
+	//NOTE: a client leaving early must not kill the server
+	signal( SIGPIPE, SIG_IGN );
+
+	if( strcmp(engine, "cube") == 0 )
+		return run<sudoku::Solver>( path, jobs );
+	else if( strcmp(engine, "bits") == 0 )
+		return run<sudoku::BitSolver>( path, jobs );
+	else if( strcmp(engine, "dlx") == 0 )
+		return run<sudoku::DlxSolver>( path, jobs );
+
+	usage(argv[0]);
+	return -1;
+}
@@ -1,8 +1,10 @@
 #ifndef SUDOKU_STOPPER_H
 #define SUDOKU_STOPPER_H
-#include <sys/time.h>
+#include <time.h>
 
 
+//NOTE: the monotonic clock is not affected by setting the system time, and
+// has nanosecond resolution
 class Stopper
 {
 public:
@@ -11,9 +13,9 @@ public:
 
 	static double  now() 
 	{
-		timeval tv;
-		gettimeofday(&tv, 0);
-		return tv.tv_sec + (double)tv.tv_usec / 1e6;
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec + (double)ts.tv_nsec / 1e9;
 	}
 
 private:
@@ -0,0 +1,177 @@
+#include "batch.h"
+#include "bits/lanes.h"
+#include "bits/geometry.h"
+#include <cstring>
+
+
+namespace sudoku {
+
+namespace lanes {
+
+// Kernels of the other instruction sets, see batch_sse2.cc and batch_avx2.cc
+#if defined(__x86_64__) || defined(__i386__)
+void  propagateSse2( unsigned short *cells, unsigned short *invalid, const Geometry &g );
+void  propagateAvx2( unsigned short *cells, unsigned short *invalid, const Geometry &g );
+#endif
+
+namespace {
+
+// The scalar kernel has no propagate function, its tables go to the BitSolver
+struct Kernel
+{
+	const char  *name;
+	int  lanes;
+	void  (*propagate)( unsigned short *cells, unsigned short *invalid, const Geometry &g );
+
+	// The best kernel supported by the machine
+	Kernel()
+	{
+		if( !select("avx2") && !select("sse2") )
+			select("scalar");
+	}
+
+	bool  select( const char *n )
+	{
+		if( strcmp(n, "scalar") == 0 )
+			return set( "scalar", 1, 0 );
+
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if( strcmp(n, "avx2") == 0 && __builtin_cpu_supports("avx2") )
+			return set( "avx2", 16, propagateAvx2 );
+
+		if( strcmp(n, "sse2") == 0 && __builtin_cpu_supports("sse2") )
+			return set( "sse2", 8, propagateSse2 );
+#endif
+
+		return false;
+	}
+
+	bool  set( const char *n, const int l, void (*p)( unsigned short*, unsigned short*, const Geometry& ) )
+	{
+		name = n;
+		lanes = l;
+		propagate = p;
+		return true;
+	}
+};
+
+Kernel  kernel;
+
+}
+}
+
+
+BatchSolver::BatchSolver()
+{
+}
+
+const char*  BatchSolver::kernel()
+{
+	return lanes::kernel.name;
+}
+
+int  BatchSolver::lanes()
+{
+	return lanes::kernel.lanes;
+}
+
+bool  BatchSolver::selectKernel( const char *name )
+{
+	return lanes::kernel.select(name);
+}
+
+size_t  BatchSolver::solveBatch( const Table *in, Table *out, const size_t n )
+{
+	_outcomes.resize(n);
+
+	const int  width = lanes();
+	for( size_t i = 0; i < n; i += width )
+		solveGroup( in + i, out + i, &_outcomes[i], (n - i < (size_t) width) ? (int) (n - i) : width );
+
+	size_t  solved = 0;
+	for( size_t i = 0; i != n; ++i )
+		solved += _outcomes[i].solved;
+
+	return solved;
+}
+
+void  BatchSolver::solveGroup( const Table *in, Table *out, Outcome *outcomes, const int n )
+{
+	if( !lanes::kernel.propagate )
+	{
+		for( int l = 0; l != n; ++l )
+			search( in[l], in[l], out[l], outcomes[l] );
+
+		return;
+	}
+
+	const int  width = lanes();
+
+	//NOTE: the unused lanes are left without any single, so they never change
+	for( int c = 0; c != 81; ++c )
+		for( int l = 0; l != width; ++l )
+		{
+			const int  v = (l < n) ? in[l](c % 9, c / 9) : (int) Table::empty;
+			_cells[c * width + l] = (v >= 1 && v <= 9) ? 1 << (v - 1) : (unsigned short) BitSolver::ALL_DIGITS;
+		}
+
+	const BitGeometry<3>  &g = BitGeometry<3>::instance;
+	const lanes::Geometry  geometry = { g.cells_of_house, g.peers };
+	lanes::kernel.propagate( _cells, _invalid, geometry );
+
+	for( int l = 0; l != n; ++l )
+	{
+		Outcome  &o = outcomes[l];
+		o.searched = false;
+		o.decisions = o.backsteps = 0;
+
+		// The propagated state: the single cells are known
+		Table  state;
+		bool  complete = true;
+		for( int c = 0; c != 81; ++c )
+		{
+			const unsigned short  m = _cells[c * width + l];
+			if( m != 0 && (m & (m - 1)) == 0 )
+				state(c % 9, c / 9) = __builtin_ctz(m) + 1;
+			else
+			{
+				state(c % 9, c / 9) = Table::empty;
+				complete = false;
+			}
+		}
+
+		if( _invalid[l] )
+		{
+			o.solved = false;
+			out[l] = in[l];
+			continue;
+		}
+
+		if( complete )
+		{
+			o.solved = true;
+			out[l] = state;
+			continue;
+		}
+
+		// The singles got stuck, branching is needed
+		search( in[l], state, out[l], o );
+	}
+}
+
+void  BatchSolver::search( const Table &in, const Table &state, Table &out, Outcome &o )
+{
+	_solver.init(state);
+	o.solved = _solver.run();
+	o.searched = true;
+	o.decisions = _solver.decisions();
+	o.backsteps = _solver.backsteps();
+
+	if( o.solved )
+		_solver.extractTable(out);
+	else
+		out = in;
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef SUDOKU_BATCH_H
+#define SUDOKU_BATCH_H
+
+#include "table.h"
+#include "bitsolver.h"
+#include <cstddef>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	//NOTE: Lockstep batch solver
+	// Solves many tables at once for throughput. The tables are grouped into
+	// the lanes of SIMD vectors (16 with AVX2 or 8 with SSE2, chosen at
+	// runtime) and the naked and hidden singles are propagated in all lanes
+	// in lockstep. The tables which need branching are finished by a
+	// BitSolver from the propagated state. Without SIMD support (the scalar
+	// kernel) every table goes to the BitSolver.
+	class BatchSolver
+	{
+	public:
+		typedef Table  TableType;
+
+		struct Outcome
+		{
+			bool  solved;
+			bool  searched; // went to the BitSolver
+			int  decisions;
+			int  backsteps;
+		};
+
+		BatchSolver();
+
+		// Solves the n tables of in into out (they may be the same), returns
+		// the number of solved tables
+		size_t  solveBatch( const Table *in, Table *out, const size_t n );
+
+		// Outcome of the i-th table of the last batch
+		inline const Outcome&  outcome( const size_t i ) const {
+			return _outcomes[i];
+		}
+
+		// Name of the instruction set of the propagation kernel
+		static const char*  kernel();
+
+		// Number of tables propagated in a lockstep group
+		static int  lanes();
+
+		// Switches to the named kernel (scalar, sse2 or avx2) for every
+		// BatchSolver, returns false if the machine does not support it.
+		// Not to be called while a batch is being solved.
+		static bool  selectKernel( const char *name );
+
+	private:
+		enum {
+			MAX_LANES = 16,
+		};
+
+		unsigned short  _cells[81 * MAX_LANES];
+		unsigned short  _invalid[MAX_LANES];
+		std::vector<Outcome>  _outcomes;
+		BitSolver  _solver;
+
+		void  solveGroup( const Table *in, Table *out, Outcome *outcomes, const int n );
+		void  search( const Table &in, const Table &state, Table &out, Outcome &o );
+	};
+}
+#endif
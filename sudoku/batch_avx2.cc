@@ -0,0 +1,48 @@
+// The AVX2 kernel of the BatchSolver, 16 tables in the 16-bit lanes.
+// Nothing else may be included here, see bits/lanes.h
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#pragma GCC target("avx2")
+#include <immintrin.h>
+#include "bits/lanes.h"
+
+
+namespace sudoku {
+namespace lanes {
+
+namespace {
+
+struct Avx2
+{
+	typedef __m256i  Vector;
+
+	enum {
+		LANES = 16,
+	};
+
+	static inline Vector  load( const unsigned short *p )  { return _mm256_loadu_si256( (const __m256i*) p ); }
+	static inline void  store( unsigned short *p, const Vector v )  { _mm256_storeu_si256( (__m256i*) p, v ); }
+	static inline Vector  zero()  { return _mm256_setzero_si256(); }
+	static inline Vector  ones()  { return _mm256_set1_epi16(-1); }
+	static inline Vector  set( const unsigned short x )  { return _mm256_set1_epi16(x); }
+	static inline Vector  band( const Vector a, const Vector b )  { return _mm256_and_si256( a, b ); }
+	static inline Vector  bor( const Vector a, const Vector b )  { return _mm256_or_si256( a, b ); }
+	static inline Vector  andnot( const Vector a, const Vector b )  { return _mm256_andnot_si256( a, b ); }
+	static inline Vector  dec( const Vector a )  { return _mm256_sub_epi16( a, _mm256_set1_epi16(1) ); }
+	static inline Vector  isZero( const Vector a )  { return _mm256_cmpeq_epi16( a, _mm256_setzero_si256() ); }
+	static inline Vector  equal( const Vector a, const Vector b )  { return _mm256_cmpeq_epi16( a, b ); }
+	static inline bool  any( const Vector a )  { return !_mm256_testz_si256( a, a ); }
+};
+
+}
+
+void  propagateAvx2( unsigned short *cells, unsigned short *invalid, const Geometry &g )
+{
+	propagate<Avx2>( cells, invalid, g );
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,48 @@
+// The SSE2 kernel of the BatchSolver, 8 tables in the 16-bit lanes.
+// Nothing else may be included here, see bits/lanes.h
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#pragma GCC target("sse2")
+#include <emmintrin.h>
+#include "bits/lanes.h"
+
+
+namespace sudoku {
+namespace lanes {
+
+namespace {
+
+struct Sse2
+{
+	typedef __m128i  Vector;
+
+	enum {
+		LANES = 8,
+	};
+
+	static inline Vector  load( const unsigned short *p )  { return _mm_loadu_si128( (const __m128i*) p ); }
+	static inline void  store( unsigned short *p, const Vector v )  { _mm_storeu_si128( (__m128i*) p, v ); }
+	static inline Vector  zero()  { return _mm_setzero_si128(); }
+	static inline Vector  ones()  { return _mm_set1_epi16(-1); }
+	static inline Vector  set( const unsigned short x )  { return _mm_set1_epi16(x); }
+	static inline Vector  band( const Vector a, const Vector b )  { return _mm_and_si128( a, b ); }
+	static inline Vector  bor( const Vector a, const Vector b )  { return _mm_or_si128( a, b ); }
+	static inline Vector  andnot( const Vector a, const Vector b )  { return _mm_andnot_si128( a, b ); }
+	static inline Vector  dec( const Vector a )  { return _mm_sub_epi16( a, _mm_set1_epi16(1) ); }
+	static inline Vector  isZero( const Vector a )  { return _mm_cmpeq_epi16( a, _mm_setzero_si128() ); }
+	static inline Vector  equal( const Vector a, const Vector b )  { return _mm_cmpeq_epi16( a, b ); }
+	static inline bool  any( const Vector a )  { return _mm_movemask_epi8( _mm_cmpeq_epi16( a, _mm_setzero_si128() ) ) != 0xFFFF; }
+};
+
+}
+
+void  propagateSse2( unsigned short *cells, unsigned short *invalid, const Geometry &g )
+{
+	propagate<Sse2>( cells, invalid, g );
+}
+
+}
+}
+
+#endif
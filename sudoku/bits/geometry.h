@@ -0,0 +1,61 @@
+#ifndef SUDOKU_BITS_GEOMETRY_H
+#define SUDOKU_BITS_GEOMETRY_H
+
+#include "../bitsolver.h"
+
+
+
+namespace sudoku
+{
+	// Cell address is y * SIZE + x, houses are numbered rows, columns, then
+	// boxes (0 to SIZE-1, SIZE to 2*SIZE-1, and so on).
+	template< int BOX >
+	struct BitGeometry
+	{
+		typedef typename BitTraits<BOX>::Index  Index;
+
+		enum {
+			SIZE = BOX * BOX,
+			CELLS = SIZE * SIZE,
+			HOUSES = 3 * SIZE,
+			PEERS = 2 * (SIZE - 1) + (BOX - 1) * (BOX - 1),
+		};
+
+		Index  house_of_cell[CELLS][3];
+		Index  cells_of_house[HOUSES][SIZE];
+		Index  peers[CELLS][PEERS];
+
+		static const BitGeometry  instance;
+
+		BitGeometry()
+		{
+			for( int y = 0; y != SIZE; ++y )
+				for( int x = 0; x != SIZE; ++x )
+				{
+					const int  c = y * SIZE + x;
+					const int  b = (y / BOX) * BOX + x / BOX;
+
+					house_of_cell[c][0] = y;
+					house_of_cell[c][1] = SIZE + x;
+					house_of_cell[c][2] = 2 * SIZE + b;
+
+					cells_of_house[y][x] = c;
+					cells_of_house[SIZE + x][y] = c;
+					cells_of_house[2 * SIZE + b][(y % BOX) * BOX + x % BOX] = c;
+				}
+
+			for( int c = 0; c != CELLS; ++c )
+			{
+				int  n = 0;
+				for( int p = 0; p != CELLS; ++p )
+					if( p != c && (house_of_cell[p][0] == house_of_cell[c][0] || house_of_cell[p][1] == house_of_cell[c][1]
+							|| house_of_cell[p][2] == house_of_cell[c][2]) )
+						peers[c][n++] = p;
+			}
+		}
+	};
+
+	template< int BOX >
+	const BitGeometry<BOX>  BitGeometry<BOX>::instance;
+}
+#endif
@@ -0,0 +1,118 @@
+#ifndef SUDOKU_BITS_LANES_H
+#define SUDOKU_BITS_LANES_H
+
+//NOTE: Lane-parallel singles propagation
+// Every lane of a vector holds the 9-bit candidate mask of the same cell of
+// a different table, so the tables of a group are propagated in lockstep.
+// The kernel is instantiated in separate translation units, one per
+// instruction set (compiled with the matching target options), so this
+// header must not include anything nor define non-template functions.
+//
+// The vector type V provides:
+//   Vector, LANES
+//   load(p), store(p,v), zero(), ones(), set(x)
+//   band(a,b), bor(a,b), andnot(a,b) = ~a & b, dec(a) = a - 1
+//   isZero(a): all-ones in the lanes where a is zero
+//   equal(a,b): all-ones in the lanes where a == b
+//   any(a): whether any lane of a is nonzero
+
+
+
+namespace sudoku
+{
+	namespace lanes
+	{
+		// The tables of BitGeometry<3>, which cannot be included here: cell
+		// address is y * 9 + x, houses are rows, columns, then boxes
+		struct Geometry
+		{
+			const unsigned char  (*cells_of_house)[9];
+			const unsigned char  (*peers)[20];
+		};
+
+		// cells: [81][LANES] candidate masks, propagated in place
+		// invalid: [LANES] nonzero for the tables which turned out unsolvable
+		template< typename V >
+		void  propagate( unsigned short *cells, unsigned short *invalid, const Geometry &g )
+		{
+			typedef typename V::Vector  Vector;
+
+			Vector  m[81], done[81];
+			for( int c = 0; c != 81; ++c )
+			{
+				m[c] = V::load( cells + c * V::LANES );
+				done[c] = V::zero();
+			}
+
+			const Vector  all = V::set(0x1FF);
+			Vector  bad = V::zero();
+
+			bool  changed = true;
+			while( changed )
+			{
+				changed = false;
+
+				// Naked singles: remove the value of the new single cells from their peers
+				for( int c = 0; c != 81; ++c )
+				{
+					const Vector  single = V::andnot( V::isZero(m[c]), V::isZero( V::band( m[c], V::dec(m[c]) ) ) );
+					const Vector  fresh = V::andnot( done[c], single );
+					if( !V::any(fresh) )
+						continue;
+
+					done[c] = V::bor( done[c], fresh );
+
+					const Vector  bits = V::band( m[c], fresh );
+					for( int i = 0; i != 20; ++i )
+						m[ g.peers[c][i] ] = V::andnot( bits, m[ g.peers[c][i] ] );
+
+					changed = true;
+				}
+
+				// Hidden singles: a digit with only one possible cell in a house
+				for( int h = 0; h != 27; ++h )
+				{
+					Vector  once = V::zero(), twice = V::zero();
+					for( int i = 0; i != 9; ++i )
+					{
+						const Vector  x = m[ g.cells_of_house[h][i] ];
+						twice = V::bor( twice, V::band( once, x ) );
+						once = V::bor( once, x );
+					}
+
+					// Some digit has no place left in the house
+					bad = V::bor( bad, V::andnot( V::equal( once, all ), V::ones() ) );
+
+					const Vector  hidden = V::andnot( twice, once );
+					if( !V::any(hidden) )
+						continue;
+
+					for( int i = 0; i != 9; ++i )
+					{
+						const int  c = g.cells_of_house[h][i];
+						const Vector  x = V::band( m[c], hidden );
+
+						// Two digits bound to the same cell
+						bad = V::bor( bad, V::andnot( V::isZero( V::band( x, V::dec(x) ) ), V::ones() ) );
+
+						const Vector  apply = V::andnot( V::bor( V::isZero(x), V::equal( x, m[c] ) ), V::ones() );
+						if( !V::any(apply) )
+							continue;
+
+						m[c] = V::bor( V::band( apply, x ), V::andnot( apply, m[c] ) );
+						changed = true;
+					}
+				}
+			}
+
+			for( int c = 0; c != 81; ++c )
+			{
+				bad = V::bor( bad, V::isZero(m[c]) );
+				V::store( cells + c * V::LANES, m[c] );
+			}
+
+			V::store( invalid, bad );
+		}
+	}
+}
+#endif
@@ -1,6 +1,8 @@
 #ifndef SUDOKU_BITS_MATRIX_H
 #define SUDOKU_BITS_MATRIX_H
 
+#include <cstring>
+
 
 
 template< typename VALUE, int SIZE >
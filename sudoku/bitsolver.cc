@@ -0,0 +1,267 @@
+#include "bitsolver.h"
+#include "bits/geometry.h"
+
+
+namespace sudoku {
+
+namespace {
+
+template< typename MASK >
+inline bool  isSingle( const MASK m )
+{
+	return (m & (m - 1)) == 0;
+}
+
+template< typename MASK >
+inline int  lowestDigit( const MASK m )
+{
+	return __builtin_ctz( m );
+}
+
+}
+
+
+template< int BOX >
+BasicBitSolver<BOX>::BasicBitSolver()
+	: _stack( CELLS + 1 ), _branches( CELLS ), _depth(0), _consistent(false), _open(false), _decisions(0), _backsteps(0)
+{}
+
+template< int BOX >
+bool  BasicBitSolver<BOX>::place( State &s, const int cell, const int digit )
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+
+	const Mask  bit = (Mask) 1 << digit;
+	if( !(s.cells[cell] & bit) )
+		return false;
+
+	s.cells[cell] = 0;
+	s.values[cell] = digit + 1;
+	--s.free;
+
+	for( int i = 0; i != 3; ++i )
+		s.houses[ geometry.house_of_cell[cell][i] ] |= bit;
+
+	for( int i = 0; i != BitGeometry<BOX>::PEERS; ++i )
+		s.cells[ geometry.peers[cell][i] ] &= ~bit;
+
+	return true;
+}
+
+template< int BOX >
+bool  BasicBitSolver<BOX>::propagate( State &s )
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+
+	bool  progress = true;
+	while( progress && s.free != 0 )
+	{
+		progress = false;
+
+		// Naked singles: cells with only one candidate left
+		for( int c = 0; c != CELLS; ++c )
+		{
+			if( s.values[c] != TableType::empty )
+				continue;
+
+			const Mask  m = s.cells[c];
+			if( m == 0 )
+				return false;
+
+			if( isSingle(m) )
+			{
+				place( s, c, lowestDigit(m) );
+				progress = true;
+			}
+		}
+
+		// Hidden singles: digits with only one possible cell left in a house
+		for( int h = 0; h != HOUSES; ++h )
+		{
+			Mask  once = 0, twice = 0;
+			for( int i = 0; i != SIZE; ++i )
+			{
+				const Mask  m = s.cells[ geometry.cells_of_house[h][i] ];
+				twice |= once & m;
+				once |= m;
+			}
+
+			if( (once | s.houses[h]) != ALL_DIGITS )
+				return false;
+
+			const Mask  hidden = once & ~twice;
+			if( hidden == 0 )
+				continue;
+
+			for( int i = 0; i != SIZE; ++i )
+			{
+				const int  c = geometry.cells_of_house[h][i];
+				const Mask  m = s.cells[c] & hidden;
+				if( m == 0 )
+					continue;
+
+				//NOTE: two digits bound to the same cell
+				if( !isSingle(m) )
+					return false;
+
+				place( s, c, lowestDigit(m) );
+				progress = true;
+			}
+		}
+	}
+
+	return true;
+}
+
+template< int BOX >
+int  BasicBitSolver<BOX>::selectCell( const State &s )
+{
+	int  best = -1, best_count = SIZE + 1;
+	for( int c = 0; c != CELLS; ++c )
+	{
+		if( s.values[c] != TableType::empty )
+			continue;
+
+		const int  count = __builtin_popcount( s.cells[c] );
+		if( count < best_count )
+		{
+			best = c;
+			best_count = count;
+			if( count == 2 )
+				break;
+		}
+	}
+
+	return best;
+}
+
+
+template< int BOX >
+void  BasicBitSolver<BOX>::init( const TableType& t )
+{
+	State  &s = _stack[0];
+	for( int c = 0; c != CELLS; ++c )
+	{
+		s.cells[c] = ALL_DIGITS;
+		s.values[c] = TableType::empty;
+	}
+	for( int h = 0; h != HOUSES; ++h )
+		s.houses[h] = 0;
+	s.free = CELLS;
+
+	_consistent = true;
+	for( int y = 0; y != SIZE; ++y )
+		for( int x = 0; x != SIZE; ++x )
+			if( t(x,y) != TableType::empty )
+				if( t(x,y) < 1 || t(x,y) > SIZE || !place( s, y * SIZE + x, t(x,y) - 1 ) )
+					_consistent = false;
+
+	_depth = 0;
+	_open = false;
+	_decisions = _backsteps = 0;
+}
+
+template< int BOX >
+void  BasicBitSolver<BOX>::exclude( const int x, const int y, const Value v )
+{
+	//NOTE: a cell left without candidates is found by the propagation
+	if( v >= 1 && v <= SIZE )
+		_stack[0].cells[ y * SIZE + x ] &= ~((Mask) 1 << (v - 1));
+}
+
+template< int BOX >
+bool  BasicBitSolver<BOX>::run()
+{
+	_depth = 0;
+	_open = false;
+	if( !_consistent || !propagate( _stack[0] ) )
+	{
+		++_backsteps;
+		return false;
+	}
+
+	if( _stack[0].free == 0 )
+		return true;
+
+	_branches[0].cell = selectCell( _stack[0] );
+	_branches[0].remaining = _stack[0].cells[ _branches[0].cell ];
+	_open = true;
+
+	return search();
+}
+
+template< int BOX >
+bool  BasicBitSolver<BOX>::next()
+{
+	//NOTE: the last solution is taken as a dead end, so the search goes on
+	// with the next candidate of the last branch
+	++_backsteps;
+
+	if( !_open )
+		return false;
+
+	--_depth;
+	return search();
+}
+
+template< int BOX >
+bool  BasicBitSolver<BOX>::search()
+{
+	while( true )
+	{
+		Branch  &branch = _branches[_depth];
+		if( branch.remaining == 0 )
+		{
+			//NOTE: no more candidates were left, so we must step back
+			++_backsteps;
+
+			if( _depth == 0 )
+			{
+				_open = false;
+				return false;
+			}
+
+			--_depth;
+			continue;
+		}
+
+		++_decisions;
+
+		const int  digit = lowestDigit( branch.remaining );
+		branch.remaining &= branch.remaining - 1;
+
+		State  &next = _stack[_depth + 1];
+		next = _stack[_depth];
+		place( next, branch.cell, digit );
+
+		if( !propagate(next) )
+		{
+			++_backsteps;
+			continue;
+		}
+
+		++_depth;
+		if( next.free == 0 )
+			return true;
+
+		_branches[_depth].cell = selectCell( next );
+		_branches[_depth].remaining = next.cells[ _branches[_depth].cell ];
+	}
+}
+
+template< int BOX >
+void  BasicBitSolver<BOX>::extractTable( TableType& t ) const
+{
+	const State  &s = _stack[_depth];
+	for( int y = 0; y != SIZE; ++y )
+		for( int x = 0; x != SIZE; ++x )
+			t(x,y) = s.values[ y * SIZE + x ];
+}
+
+
+template class BasicBitSolver<2>;
+template class BasicBitSolver<3>;
+template class BasicBitSolver<4>;
+template class BasicBitSolver<5>;
+
+}
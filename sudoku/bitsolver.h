@@ -0,0 +1,116 @@
+#ifndef SUDOKU_BITSOLVER_H
+#define SUDOKU_BITSOLVER_H
+
+#include "table.h"
+#include <stdint.h>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	// Candidate mask (one bit per value) and cell index types of a box size
+	template< int BOX >
+	struct BitTraits
+	{
+		typedef uint16_t  Mask;
+		typedef uint8_t  Index;
+	};
+
+	template<>
+	struct BitTraits<4>
+	{
+		typedef uint16_t  Mask;
+		typedef uint16_t  Index;
+	};
+
+	template<>
+	struct BitTraits<5>
+	{
+		typedef uint32_t  Mask;
+		typedef uint16_t  Index;
+	};
+
+
+	//NOTE: Bitboard engine
+	// Same interface as Solver, but the candidates are kept as digit masks:
+	// one per cell, and one per house (row, column, box) holding the digits
+	// already placed in it. Placing a value is a handful of AND/OR operations
+	// on the peers, single detection is a popcount. Instantiated in
+	// bitsolver.cc for the same box sizes as BasicTable.
+	template< int BOX >
+	class BasicBitSolver
+	{
+	public:
+		typedef BasicTable<BOX>  TableType;
+		typedef typename BitTraits<BOX>::Mask  Mask;
+
+		enum {
+			SIZE = BOX * BOX,
+			CELLS = SIZE * SIZE,
+			HOUSES = 3 * SIZE,
+			ALL_DIGITS = (1 << SIZE) - 1,
+		};
+
+		BasicBitSolver();
+
+	private:
+		typedef typename TableType::Value  Value;
+
+		struct State
+		{
+			Mask  cells[CELLS];   // candidates of the cell, 0 when occupied
+			Mask  houses[HOUSES]; // placed digits: rows, then columns, then boxes
+			unsigned char  values[CELLS];
+			int  free;
+		};
+
+		struct Branch
+		{
+			int  cell;
+			Mask  remaining;
+		};
+
+		//NOTE: kept on the heap, a 25x25 stack is a few megabytes
+		std::vector<State>  _stack;
+		std::vector<Branch>  _branches;
+		int  _depth;
+		bool  _consistent;
+		bool  _open; // the search has branches left to try
+
+		// statistical info
+		int  _decisions;
+		int  _backsteps;
+
+		static bool  place( State &s, const int cell, const int digit );
+		static bool  propagate( State &s );
+		static int  selectCell( const State &s );
+
+		bool  search();
+
+	public:
+		void  init( const TableType& t );
+
+		// Rules out a value of a cell, between init() and run()
+		void  exclude( const int x, const int y, const Value v );
+
+		bool  run();
+
+		// Continues the search after the solution found by run() or the
+		// previous next(), returns false when there are no more solutions
+		bool  next();
+
+		void  extractTable( TableType& t ) const;
+
+		inline int  decisions() const {
+			return _decisions;
+		}
+
+		inline int  backsteps() const {
+			return _backsteps;
+		}
+	};
+
+	typedef BasicBitSolver<3>  BitSolver;
+}
+#endif
@@ -0,0 +1,110 @@
+#include "cache.h"
+#include <algorithm>
+
+
+namespace sudoku {
+
+SolutionCache::SolutionCache( const size_t capacity, const int shards )
+	: _capacity(capacity), _shards( std::min( capacity, (size_t) (shards < 1 ? 1 : shards) ) )
+{
+	//NOTE: the first capacity % n shards take one entry more
+	const size_t  n = _shards.size();
+	for( size_t i = 0; i != n; ++i )
+	{
+		pthread_mutex_init( &_shards[i].lock, 0 );
+		_shards[i].capacity = capacity / n + (i < capacity % n ? 1 : 0);
+		_shards[i].evictions = 0;
+	}
+}
+
+SolutionCache::~SolutionCache()
+{
+	for( size_t i = 0; i != _shards.size(); ++i )
+		pthread_mutex_destroy( &_shards[i].lock );
+}
+
+std::string  SolutionCache::keyOf( const Table &form )
+{
+	unsigned char  record[PackedFormat::RECORD_SIZE];
+	PackedFormat::encode( form, record );
+	return std::string( (const char*) record, sizeof(record) );
+}
+
+SolutionCache::Shard&  SolutionCache::shardOf( const std::string &key )
+{
+	//NOTE: FNV-1a
+	unsigned  hash = 2166136261u;
+	for( size_t i = 0; i != key.size(); ++i )
+		hash = (hash ^ (unsigned char) key[i]) * 16777619u;
+
+	return _shards[ hash % _shards.size() ];
+}
+
+bool  SolutionCache::find( const Table &form, Table &solution )
+{
+	if( !enabled() )
+		return false;
+
+	const std::string  key = keyOf(form);
+	Shard  &shard = shardOf(key);
+
+	pthread_mutex_lock( &shard.lock );
+
+	std::map<std::string, Entries::iterator>::iterator  it = shard.index.find(key);
+	const bool  found = it != shard.index.end();
+	if( found )
+	{
+		shard.entries.splice( shard.entries.begin(), shard.entries, it->second );
+		PackedFormat::decode( it->second->solution, solution );
+	}
+
+	pthread_mutex_unlock( &shard.lock );
+	return found;
+}
+
+void  SolutionCache::insert( const Table &form, const Table &solution )
+{
+	if( !enabled() )
+		return;
+
+	const std::string  key = keyOf(form);
+	Shard  &shard = shardOf(key);
+
+	pthread_mutex_lock( &shard.lock );
+
+	//NOTE: another worker may have solved the same form meanwhile
+	if( shard.index.find(key) == shard.index.end() )
+	{
+		if( shard.index.size() == shard.capacity )
+		{
+			shard.index.erase( shard.entries.back().key );
+			shard.entries.pop_back();
+			++shard.evictions;
+		}
+
+		shard.entries.push_front( Entry() );
+		shard.entries.front().key = key;
+		PackedFormat::encode( solution, shard.entries.front().solution );
+		shard.index[key] = shard.entries.begin();
+	}
+
+	pthread_mutex_unlock( &shard.lock );
+}
+
+size_t  SolutionCache::size() const
+{
+	size_t  n = 0;
+	for( size_t i = 0; i != _shards.size(); ++i )
+		n += _shards[i].index.size();
+	return n;
+}
+
+long  SolutionCache::evictions() const
+{
+	long  n = 0;
+	for( size_t i = 0; i != _shards.size(); ++i )
+		n += _shards[i].evictions;
+	return n;
+}
+
+}
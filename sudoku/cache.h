@@ -0,0 +1,72 @@
+#ifndef SUDOKU_CACHE_H
+#define SUDOKU_CACHE_H
+
+#include "table.h"
+#include "packed.h"
+#include <pthread.h>
+#include <string>
+#include <list>
+#include <map>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	//NOTE: Solution cache
+	// A bounded LRU map from the canonical forms of the tables (see
+	// canonicalize()) to their solutions, both kept in the packed format.
+	// It is split into shards by the hash of the form, each with its own
+	// lock and its share of the capacity, so the workers of a pool rarely
+	// wait for each other. There are no more shards than the capacity, and
+	// the shares add up to it exactly. A cache of capacity 0 is disabled.
+	class SolutionCache
+	{
+	public:
+		explicit SolutionCache( const size_t capacity, const int shards = 16 );
+		~SolutionCache();
+
+		inline bool  enabled() const {
+			return _capacity != 0;
+		}
+
+		// Returns false on a miss
+		bool  find( const Table &form, Table &solution );
+
+		// The least recently used entry of the shard is dropped when it is full
+		void  insert( const Table &form, const Table &solution );
+
+		// Read without the locks, so only when no worker uses the cache
+		size_t  size() const;
+		long  evictions() const;
+
+	private:
+		struct Entry
+		{
+			std::string  key;
+			unsigned char  solution[PackedFormat::RECORD_SIZE];
+		};
+
+		typedef std::list<Entry>  Entries;
+
+		struct Shard
+		{
+			pthread_mutex_t  lock;
+			Entries  entries; // the most recently used first
+			std::map<std::string, Entries::iterator>  index;
+			size_t  capacity;
+			long  evictions;
+		};
+
+		size_t  _capacity;
+		std::vector<Shard>  _shards;
+
+		Shard&  shardOf( const std::string &key );
+
+		static std::string  keyOf( const Table &form );
+
+		SolutionCache( const SolutionCache& );
+		SolutionCache&  operator= ( const SolutionCache& );
+	};
+}
+#endif
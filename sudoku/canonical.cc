@@ -0,0 +1,238 @@
+#include "canonical.h"
+#include <algorithm>
+
+
+namespace sudoku {
+
+namespace {
+
+enum {
+	MAX_ORDERS = 32, // tied orders tried for the rows, and for the columns
+};
+
+// An order of the lines of one direction (rows or columns), from the bands
+// in order, each with its lines in order
+struct Order
+{
+	int  lines[9];
+};
+
+// The orders of three items by descending keys, more than one if some keys
+// are equal, returns their count
+template< typename KEY >
+int  orderThree( const KEY *keys, const int *items, int orders[6][3] )
+{
+	static const int  permutations[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+
+	int  n = 0;
+	for( int p = 0; p != 6; ++p )
+	{
+		const int  a = items[ permutations[p][0] ], b = items[ permutations[p][1] ], c = items[ permutations[p][2] ];
+		if( keys[a] < keys[b] || keys[b] < keys[c] )
+			continue;
+
+		orders[n][0] = a;
+		orders[n][1] = b;
+		orders[n][2] = c;
+		++n;
+	}
+
+	return n;
+}
+
+// A band is ordered by the keys of its lines, largest first
+struct BandKey
+{
+	int  keys[3];
+
+	inline bool  operator< ( const BandKey &o ) const {
+		return std::lexicographical_compare( keys, keys + 3, o.keys, o.keys + 3 );
+	}
+};
+
+// Lists the orders of the lines whose keys are given, returns their count
+int  listOrders( const int *keys, Order *result )
+{
+	BandKey  bands[3];
+	for( int b = 0; b != 3; ++b )
+	{
+		for( int i = 0; i != 3; ++i )
+			bands[b].keys[i] = keys[b * 3 + i];
+		std::sort( bands[b].keys, bands[b].keys + 3 );
+		std::reverse( bands[b].keys, bands[b].keys + 3 );
+	}
+
+	const int  band_items[3] = { 0, 1, 2 };
+	int  band_orders[6][3];
+	const int  band_count = orderThree( bands, band_items, band_orders );
+
+	int  n = 0;
+	for( int o = 0; o != band_count; ++o )
+	{
+		int  line_orders[3][6][3], line_counts[3];
+		for( int b = 0; b != 3; ++b )
+		{
+			const int  band = band_orders[o][b];
+			const int  lines[3] = { band * 3, band * 3 + 1, band * 3 + 2 };
+			line_counts[b] = orderThree( keys, lines, line_orders[b] );
+		}
+
+		for( int i = 0; i != line_counts[0]; ++i )
+			for( int j = 0; j != line_counts[1]; ++j )
+				for( int k = 0; k != line_counts[2]; ++k )
+				{
+					if( n == MAX_ORDERS )
+						return n;
+
+					std::copy( line_orders[0][i], line_orders[0][i] + 3, result[n].lines );
+					std::copy( line_orders[1][j], line_orders[1][j] + 3, result[n].lines + 3 );
+					std::copy( line_orders[2][k], line_orders[2][k] + 3, result[n].lines + 6 );
+					++n;
+				}
+	}
+
+	return n;
+}
+
+}
+
+
+void  Transform::apply( const Table &in, Table &out ) const
+{
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; ++x )
+		{
+			const Table::Value  v = transpose ? in( rows[y], columns[x] ) : in( columns[x], rows[y] );
+			out(x,y) = (v >= 1 && v <= 9) ? digits[v] : (Table::Value) Table::empty;
+		}
+}
+
+void  Transform::revert( const Table &in, Table &out ) const
+{
+	Table::Value  original[10] = { Table::empty };
+	for( int v = 1; v != 10; ++v )
+		original[ digits[v] ] = v;
+
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; ++x )
+		{
+			const Table::Value  v = in(x,y);
+			const Table::Value  o = (v >= 1 && v <= 9) ? original[v] : (Table::Value) Table::empty;
+			if( transpose )
+				out( rows[y], columns[x] ) = o;
+			else
+				out( columns[x], rows[y] ) = o;
+		}
+}
+
+
+void  canonicalize( const Table &t, Table &form, Transform &transform )
+{
+	Table::Value  best[81];
+	bool  found = false;
+
+	for( int transpose = 0; transpose != 2; ++transpose )
+	{
+		// The givens of the (transposed) table
+		Table::Value  g[9][9];
+		int  row_count[9] = { 0 }, column_count[9] = { 0 }, digit_count[10] = { 0 };
+		for( int y = 0; y != 9; ++y )
+			for( int x = 0; x != 9; ++x )
+			{
+				const Table::Value  v = transpose ? t(y,x) : t(x,y);
+				g[y][x] = (v >= 1 && v <= 9) ? v : (Table::Value) Table::empty;
+				if( g[y][x] != Table::empty )
+				{
+					++row_count[y];
+					++column_count[x];
+					++digit_count[ g[y][x] ];
+				}
+			}
+
+		// The key of a line is its given count, then the sums of the given
+		// counts of the crossing lines and of the digits at its givens, all
+		// invariant under the symmetries
+		int  row_keys[9], column_keys[9];
+		for( int i = 0; i != 9; ++i )
+		{
+			row_keys[i] = row_count[i] * 10000;
+			column_keys[i] = column_count[i] * 10000;
+		}
+		for( int y = 0; y != 9; ++y )
+			for( int x = 0; x != 9; ++x )
+				if( g[y][x] != Table::empty )
+				{
+					row_keys[y] += column_count[x] * 100 + digit_count[ g[y][x] ];
+					column_keys[x] += row_count[y] * 100 + digit_count[ g[y][x] ];
+				}
+
+		//NOTE: the sorted keys of the rows and of the columns swap by the
+		// transposition, so only the side with the larger ones is tried, if
+		// they differ
+		int  sorted_rows[9], sorted_columns[9];
+		std::copy( row_keys, row_keys + 9, sorted_rows );
+		std::copy( column_keys, column_keys + 9, sorted_columns );
+		std::sort( sorted_rows, sorted_rows + 9 );
+		std::sort( sorted_columns, sorted_columns + 9 );
+		if( std::lexicographical_compare( sorted_rows, sorted_rows + 9, sorted_columns, sorted_columns + 9 ) )
+			continue;
+
+		Order  rows[MAX_ORDERS], columns[MAX_ORDERS];
+		const int  row_orders = listOrders( row_keys, rows );
+		const int  column_orders = listOrders( column_keys, columns );
+
+		for( int r = 0; r != row_orders; ++r )
+			for( int c = 0; c != column_orders; ++c )
+			{
+				const int  *row = rows[r].lines, *column = columns[c].lines;
+
+				// Relabels the digits as they appear, and gives up as soon as
+				// the table gets larger than the best one
+				Table::Value  digits[10] = { Table::empty };
+				Table::Value  next = 1;
+				Table::Value  candidate[81];
+				bool  smaller = !found;
+				int  i = 0;
+				for( ; i != 81; ++i )
+				{
+					Table::Value  v = g[ row[i / 9] ][ column[i % 9] ];
+					if( v != Table::empty )
+					{
+						if( digits[v] == Table::empty )
+							digits[v] = next++;
+						v = digits[v];
+					}
+					candidate[i] = v;
+
+					if( !smaller )
+					{
+						if( v > best[i] )
+							break;
+						if( v < best[i] )
+							smaller = true;
+					}
+				}
+
+				if( i != 81 || !smaller )
+					continue;
+
+				std::copy( candidate, candidate + 81, best );
+				found = true;
+
+				transform.transpose = transpose;
+				std::copy( row, row + 9, transform.rows );
+				std::copy( column, column + 9, transform.columns );
+
+				// The digits which are not given take the labels left
+				for( int v = 1; v != 10; ++v )
+					if( digits[v] == Table::empty )
+						digits[v] = next++;
+				std::copy( digits, digits + 10, transform.digits );
+			}
+	}
+
+	for( int i = 0; i != 81; ++i )
+		form( i % 9, i / 9 ) = best[i];
+}
+
+}
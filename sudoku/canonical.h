@@ -0,0 +1,35 @@
+#ifndef SUDOKU_CANONICAL_H
+#define SUDOKU_CANONICAL_H
+
+#include "table.h"
+
+
+
+namespace sudoku
+{
+	//NOTE: Canonical form
+	// The tables which are the same up to relabeling the digits, permuting
+	// the rows within the bands, the bands, the columns within the stacks,
+	// the stacks, and transposing, are mapped to one representative. Instead
+	// of trying every symmetry, the rows and the columns are ordered by
+	// invariants (given counts, and the given counts of the crossing lines),
+	// and only the orders of the ties are tried. Of these, the one giving the
+	// lexicographically smallest table (digits relabeled in the order they
+	// first appear) is the canonical form. Past a limit of tied orders the
+	// rest are not tried, then the form may depend on the input: equivalent
+	// tables may get different forms, but each is still a valid transform.
+	struct Transform
+	{
+		bool  transpose;
+		int  rows[9];      // the row y of the form is the row rows[y] of the table
+		int  columns[9];   // (after the transposition, if any)
+		Table::Value  digits[10]; // the value of the form for a value of the table
+
+		// Maps a table to the form, and back
+		void  apply( const Table &in, Table &out ) const;
+		void  revert( const Table &in, Table &out ) const;
+	};
+
+	void  canonicalize( const Table &t, Table &form, Transform &transform );
+}
+#endif
@@ -0,0 +1,159 @@
+#include "database.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace sudoku {
+
+namespace {
+
+const unsigned char  magic[4] = { 'S', 'D', 'K', 'D' };
+
+}
+
+
+SolutionDatabase::SolutionDatabase( const char *path )
+	: _open(false), _begin(0), _size(0), _records(0)
+{
+	const int  fd = path ? open( path, O_RDONLY ) : -1;
+	if( fd == -1 )
+		return;
+
+	struct stat  st;
+	if( fstat( fd, &st ) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 )
+	{
+		void  *m = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+		if( m != MAP_FAILED )
+		{
+			//NOTE: the lookups jump around the file
+			madvise( m, st.st_size, MADV_RANDOM );
+			_begin = (const unsigned char*) m;
+			_size = st.st_size;
+		}
+	}
+	close(fd);
+
+	if( _begin && checkHeader( _begin, _size ) && (_size - HEADER_SIZE) % RECORD_SIZE == 0 )
+	{
+		_records = (_size - HEADER_SIZE) / RECORD_SIZE;
+		_open = true;
+	}
+}
+
+SolutionDatabase::~SolutionDatabase()
+{
+	if( _begin )
+		munmap( (void*) _begin, _size );
+}
+
+void  SolutionDatabase::writeHeader( unsigned char *header )
+{
+	memset( header, 0, HEADER_SIZE );
+	memcpy( header, magic, 4 );
+	header[4] = VERSION;
+	header[5] = 3;
+	header[6] = RECORD_SIZE & 0xFF;
+	header[7] = RECORD_SIZE >> 8;
+}
+
+bool  SolutionDatabase::checkHeader( const unsigned char *header, const size_t size )
+{
+	return size >= HEADER_SIZE && memcmp( header, magic, 4 ) == 0 && header[4] == VERSION && header[5] == 3
+		&& (header[6] | header[7] << 8) == RECORD_SIZE;
+}
+
+bool  SolutionDatabase::find( const Table &puzzle, Table &solution ) const
+{
+	unsigned char  key[PackedFormat::RECORD_SIZE];
+	if( !_open || !PackedFormat::encode( puzzle, key ) )
+		return false;
+
+	size_t  low = 0, high = _records;
+	while( low != high )
+	{
+		const size_t  middle = low + (high - low) / 2;
+		const int  c = memcmp( record(middle), key, sizeof(key) );
+		if( c == 0 )
+			return PackedFormat::decode( record(middle) + PackedFormat::RECORD_SIZE, solution );
+
+		if( c < 0 )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return false;
+}
+
+
+bool  DatabaseWriter::Record::operator< ( const Record &o ) const
+{
+	return memcmp( bytes, o.bytes, PackedFormat::RECORD_SIZE ) < 0;
+}
+
+bool  DatabaseWriter::Record::operator== ( const Record &o ) const
+{
+	return memcmp( bytes, o.bytes, PackedFormat::RECORD_SIZE ) == 0;
+}
+
+bool  DatabaseWriter::add( const Table &puzzle, const Table &solution )
+{
+	if( solution.check() != Table::CORRECT )
+		return false;
+
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; ++x )
+			if( puzzle(x,y) != Table::empty && puzzle(x,y) != solution(x,y) )
+				return false;
+
+	Record  r;
+	if( !PackedFormat::encode( puzzle, r.bytes ) || !PackedFormat::encode( solution, r.bytes + PackedFormat::RECORD_SIZE ) )
+		return false;
+
+	_records.push_back(r);
+	return true;
+}
+
+void  DatabaseWriter::add( const SolutionDatabase &database )
+{
+	for( size_t i = 0; i != database.records(); ++i )
+	{
+		_records.push_back( Record() );
+		memcpy( _records.back().bytes, database.record(i), SolutionDatabase::RECORD_SIZE );
+	}
+}
+
+long  DatabaseWriter::write( const char *path )
+{
+	//NOTE: the stable sort keeps the first of the records of a puzzle, so
+	// the ones added earlier win
+	std::stable_sort( _records.begin(), _records.end() );
+	_records.erase( std::unique( _records.begin(), _records.end() ), _records.end() );
+
+	const std::string  temporary = std::string(path) + ".tmp";
+	std::ofstream  out( temporary.c_str(), std::ios::binary );
+
+	unsigned char  header[SolutionDatabase::HEADER_SIZE];
+	SolutionDatabase::writeHeader(header);
+	out.write( (const char*) header, sizeof(header) );
+	if( !_records.empty() )
+		out.write( (const char*) _records[0].bytes, _records.size() * sizeof(Record) );
+	out.close();
+
+	if( !out || rename( temporary.c_str(), path ) != 0 )
+	{
+		remove( temporary.c_str() );
+		return -1;
+	}
+
+	return _records.size();
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef SUDOKU_DATABASE_H
+#define SUDOKU_DATABASE_H
+
+#include "table.h"
+#include "packed.h"
+#include <cstddef>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	//NOTE: Solution database
+	// A 16 byte header: the "SDKD" magic, the format version, the box size
+	// (3), the record size as a little-endian 16-bit integer and 8 reserved
+	// zero bytes. Then fixed-size records sorted by their first half: the
+	// puzzle in the packed format (see PackedFormat), followed by its
+	// solution in the same format. The file is mapped, and a puzzle is found
+	// by a binary search on the packed bytes in place, only the solution
+	// found is decoded. The file is never changed, a DatabaseWriter writes a
+	// new one, which replaces it, so the processes reading it meanwhile keep
+	// their mapping of the old one.
+	class SolutionDatabase
+	{
+	public:
+		enum {
+			VERSION = 1,
+			HEADER_SIZE = 16,
+			RECORD_SIZE = 2 * PackedFormat::RECORD_SIZE,
+		};
+
+		// Maps the file, a database of no path is not open
+		explicit SolutionDatabase( const char *path );
+		~SolutionDatabase();
+
+		inline bool  isOpen() const {
+			return _open;
+		}
+
+		inline size_t  records() const {
+			return _records;
+		}
+
+		// Returns false if the puzzle is not stored, the puzzle and the
+		// solution may be the same table
+		bool  find( const Table &puzzle, Table &solution ) const;
+
+		// The packed bytes of the given record
+		inline const unsigned char*  record( const size_t i ) const {
+			return _begin + HEADER_SIZE + i * RECORD_SIZE;
+		}
+
+		static void  writeHeader( unsigned char *header );
+		static bool  checkHeader( const unsigned char *header, const size_t size );
+
+	private:
+		bool  _open;
+		const unsigned char  *_begin;
+		size_t  _size;
+		size_t  _records;
+
+		SolutionDatabase( const SolutionDatabase& );
+		SolutionDatabase&  operator= ( const SolutionDatabase& );
+	};
+
+
+	// Collects the records of a database in memory, then writes them sorted,
+	// each puzzle once
+	class DatabaseWriter
+	{
+	public:
+		// Returns false if the solution is not a correct solution of the puzzle
+		bool  add( const Table &puzzle, const Table &solution );
+
+		// Adds every record of a database
+		void  add( const SolutionDatabase &database );
+
+		// Writes the database to a temporary file next to path, then renames
+		// it to path, returns the number of records, or -1 on failure
+		long  write( const char *path );
+
+	private:
+		struct Record
+		{
+			unsigned char  bytes[SolutionDatabase::RECORD_SIZE];
+
+			bool  operator< ( const Record &o ) const;
+			bool  operator== ( const Record &o ) const;
+		};
+
+		std::vector<Record>  _records;
+	};
+}
+#endif
@@ -0,0 +1,282 @@
+#include "dlx.h"
+
+
+namespace sudoku {
+
+namespace {
+
+enum {
+	FIRST_ROW_NODE = DlxSolver::ROOT + 1,
+};
+
+// The area of a cell of the cube by Area::Type, as the cube addresses them:
+// the cell is x * 81 + y * 9 + v, the area type * 81 + first * 9 + second
+struct Columns
+{
+	int16_t  of[4 * DlxSolver::ROWS];
+
+	static const Columns  instance;
+
+	Columns()
+	{
+		for( int x = 0; x != 9; ++x )
+			for( int y = 0; y != 9; ++y )
+				for( int v = 0; v != 9; ++v )
+				{
+					int16_t  *areas = of + 4 * (x * 81 + y * 9 + v);
+					areas[0] = 0 * 81 + x * 9 + v;
+					areas[1] = 1 * 81 + y * 9 + v;
+					areas[2] = 2 * 81 + x * 9 + y;
+					areas[3] = 3 * 81 + v * 9 + (y / 3) * 3 + x / 3;
+				}
+	}
+};
+
+const Columns  Columns::instance;
+
+inline int  columnOf( const int node )
+{
+	return Columns::instance.of[ node - FIRST_ROW_NODE ];
+}
+
+inline int  rowOf( const int node )
+{
+	return (node - FIRST_ROW_NODE) / 4;
+}
+
+// The k-th node after the given one in its row, cyclically
+inline int  sibling( const int node, const int k )
+{
+	const int  i = node - FIRST_ROW_NODE;
+	return FIRST_ROW_NODE + (i & ~3) + ((i + k) & 3);
+}
+
+}
+
+
+DlxSolver::Links::Links()
+{
+	for( int c = 0; c <= COLUMNS; ++c )
+	{
+		left[c] = c == 0 ? ROOT : c - 1;
+		right[c] = c == ROOT ? 0 : c + 1;
+		up[c] = down[c] = c;
+	}
+
+	for( int c = 0; c != COLUMNS; ++c )
+		size[c] = 0;
+
+	//NOTE: the rows are appended in address order, so every column lists
+	// its rows by the value, or by the cell for the V areas
+	for( int node = FIRST_ROW_NODE; node != NODES; ++node )
+	{
+		const int  c = columnOf(node);
+		up[node] = up[c];
+		down[node] = c;
+		down[ up[c] ] = node;
+		up[c] = node;
+		++size[c];
+	}
+}
+
+const DlxSolver::Links  DlxSolver::Links::empty;
+
+
+DlxSolver::DlxSolver() : _consistent(false), _open(false), _depth(0), _decisions(0), _backsteps(0)
+{}
+
+void  DlxSolver::cover( const int c )
+{
+	_links.right[ _links.left[c] ] = _links.right[c];
+	_links.left[ _links.right[c] ] = _links.left[c];
+
+	for( int i = _links.down[c]; i != c; i = _links.down[i] )
+		for( int k = 1; k != 4; ++k )
+		{
+			const int  j = sibling( i, k );
+			_links.down[ _links.up[j] ] = _links.down[j];
+			_links.up[ _links.down[j] ] = _links.up[j];
+			--_links.size[ columnOf(j) ];
+		}
+}
+
+void  DlxSolver::uncover( const int c )
+{
+	for( int i = _links.up[c]; i != c; i = _links.up[i] )
+		for( int k = 3; k != 0; --k )
+		{
+			const int  j = sibling( i, k );
+			++_links.size[ columnOf(j) ];
+			_links.down[ _links.up[j] ] = j;
+			_links.up[ _links.down[j] ] = j;
+		}
+
+	_links.right[ _links.left[c] ] = c;
+	_links.left[ _links.right[c] ] = c;
+}
+
+void  DlxSolver::coverRow( const int node )
+{
+	for( int k = 1; k != 4; ++k )
+		cover( columnOf( sibling( node, k ) ) );
+}
+
+void  DlxSolver::uncoverRow( const int node )
+{
+	for( int k = 3; k != 0; --k )
+		uncover( columnOf( sibling( node, k ) ) );
+}
+
+int  DlxSolver::chooseColumn() const
+{
+	int  best = _links.right[ROOT], best_size = 10;
+	for( int c = best; c != ROOT; c = _links.right[c] )
+		if( _links.size[c] < best_size )
+		{
+			best = c;
+			best_size = _links.size[c];
+			if( best_size <= 1 )
+				break;
+		}
+
+	return best;
+}
+
+
+void  DlxSolver::init( const Table& t )
+{
+	_links = Links::empty;
+	_table = t;
+	_consistent = true;
+
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; ++x )
+		{
+			const Table::Value  v = t(x,y);
+			if( v == Table::empty )
+				continue;
+
+			if( v < 1 || v > 9 )
+			{
+				_consistent = false;
+				continue;
+			}
+
+			//NOTE: a given sharing an area with an other one finds its column
+			// covered already, the table is unsolvable
+			const int  node = FIRST_ROW_NODE + 4 * (x * 81 + y * 9 + v - 1);
+			for( int k = 0; k != 4; ++k )
+			{
+				const int  c = columnOf(node + k);
+				if( _links.right[ _links.left[c] ] != c )
+					_consistent = false;
+				else
+					cover(c);
+			}
+		}
+
+	_depth = 0;
+	_open = false;
+	_decisions = _backsteps = 0;
+}
+
+bool  DlxSolver::run()
+{
+	_depth = 0;
+	_open = false;
+	if( !_consistent )
+	{
+		++_backsteps;
+		return false;
+	}
+
+	if( _links.right[ROOT] == ROOT )
+		return true;
+
+	const int  c = chooseColumn();
+	if( _links.size[c] == 0 )
+	{
+		++_backsteps;
+		return false;
+	}
+
+	cover(c);
+	_columns[0] = _choices[0] = c;
+	_open = true;
+
+	return search();
+}
+
+bool  DlxSolver::next()
+{
+	//NOTE: the last solution is taken as a dead end, so the search goes on
+	// with the next row of the last column
+	++_backsteps;
+
+	if( !_open )
+		return false;
+
+	--_depth;
+	return search();
+}
+
+bool  DlxSolver::search()
+{
+	while( true )
+	{
+		const int  c = _columns[_depth];
+		int  node = _choices[_depth];
+		if( node != c )
+			uncoverRow(node);
+
+		node = _links.down[node];
+		if( node == c )
+		{
+			//NOTE: no more rows were left, so we must step back
+			uncover(c);
+			++_backsteps;
+
+			if( _depth == 0 )
+			{
+				_open = false;
+				return false;
+			}
+
+			--_depth;
+			continue;
+		}
+
+		if( _links.up[c] != _links.down[c] )
+			++_decisions;
+
+		_choices[_depth] = node;
+		coverRow(node);
+		++_depth;
+
+		if( _links.right[ROOT] == ROOT )
+			return true;
+
+		const int  next = chooseColumn();
+		if( _links.size[next] == 0 )
+		{
+			++_backsteps;
+			--_depth;
+			continue;
+		}
+
+		cover(next);
+		_columns[_depth] = _choices[_depth] = next;
+	}
+}
+
+void  DlxSolver::extractTable( Table& t ) const
+{
+	t = _table;
+	for( int i = 0; i != _depth; ++i )
+	{
+		const int  row = rowOf( _choices[i] );
+		t( row / 81, (row / 9) % 9 ) = row % 9 + 1;
+	}
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef SUDOKU_DLX_H
+#define SUDOKU_DLX_H
+
+#include "table.h"
+#include <stdint.h>
+
+
+
+namespace sudoku
+{
+	//NOTE: Dancing links engine
+	// Same interface as Solver, but the search is Knuth's Algorithm X on the
+	// exact cover matrix of the cube: a row for each of the 9*9*9 cells of the
+	// cube, a column for each of the 4*9*9 areas, numbered as the addresses
+	// of the areas. A row covers the 4 areas containing its cell. The matrix
+	// is kept as doubly linked lists, a covered column and the rows crossing
+	// it are unlinked, and linked back in reverse order, so backtracking
+	// needs no trail. The column with the fewest rows is chosen, a column of
+	// one row is a forced move, so only the columns of more rows count as
+	// decisions. The links are arrays of node numbers, and a solver
+	// allocates nothing.
+	class DlxSolver
+	{
+	public:
+		typedef Table  TableType;
+
+		enum {
+			ROWS = 9 * 9 * 9,
+			COLUMNS = 4 * 9 * 9,
+			ROOT = COLUMNS,
+			NODES = COLUMNS + 1 + 4 * ROWS,
+		};
+
+		DlxSolver();
+
+		void  init( const Table& t );
+
+		bool  run();
+
+		// Continues the search after the solution found by run() or the
+		// previous next(), returns false when there are no more solutions
+		bool  next();
+
+		void  extractTable( Table& t ) const;
+
+		inline int  decisions() const {
+			return _decisions;
+		}
+
+		inline int  backsteps() const {
+			return _backsteps;
+		}
+
+	private:
+		//NOTE: Nodes
+		// 0..COLUMNS-1 are the column headers, ROOT links the uncovered
+		// ones, then come the 4 nodes of each row, by Area::Type. The nodes
+		// of a row never change their horizontal links, so only the headers
+		// have them.
+		struct Links
+		{
+			int16_t  left[COLUMNS + 1];
+			int16_t  right[COLUMNS + 1];
+			int16_t  up[NODES];
+			int16_t  down[NODES];
+			int16_t  size[COLUMNS];
+
+			// The empty matrix, copied by init()
+			static const Links  empty;
+			Links();
+		};
+
+		Links  _links;
+		Table  _table; // the givens
+		bool  _consistent;
+		bool  _open; // the search has rows left to try
+
+		// The column chosen at each depth, and the row tried in it, or the
+		// column itself before the first row, a row covers a cell, so
+		// there are 9*9 depths at most
+		int16_t  _columns[9 * 9];
+		int16_t  _choices[9 * 9];
+		int  _depth;
+
+		// statistical info
+		int  _decisions;
+		int  _backsteps;
+
+		void  cover( const int c );
+		void  uncover( const int c );
+		void  coverRow( const int node );
+		void  uncoverRow( const int node );
+		int  chooseColumn() const;
+
+		bool  search();
+	};
+}
+#endif
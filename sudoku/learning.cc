@@ -0,0 +1,631 @@
+#include "learning.h"
+#include "bits/geometry.h"
+#include <algorithm>
+
+
+namespace sudoku {
+
+namespace {
+
+// The terms of the Luby sequence: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+int  luby( int i )
+{
+	for( ;; )
+	{
+		int  k = 1;
+		while( (1 << k) - 1 < i )
+			++k;
+
+		if( (1 << k) - 1 == i )
+			return 1 << (k - 1);
+
+		i -= (1 << (k - 1)) - 1;
+	}
+}
+
+// Orders the nogoods of the pool by their size
+struct BySize
+{
+	const int  *pool;
+
+	inline bool  operator() ( const int a, const int b ) const {
+		return pool[a] < pool[b];
+	}
+};
+
+}
+
+
+template< int BOX >
+BasicLearningSolver<BOX>::BasicLearningSolver()
+	: _values( VARIABLES ), _levels( VARIABLES ), _reasons( VARIABLES ), _seen( VARIABLES, 0 ), _head(0),
+	_cell_counts( CELLS ), _house_counts( HOUSES * SIZE ), _placed( CELLS ), _house_digits( HOUSES ), _free(0),
+	_watches( 2 * VARIABLES ), _learned(0), _activity( CELLS ), _bump(1.0), _consistent(false), _open(false),
+	_floor(0), _conflict_var(-1), _luby(1), _budget(0), _decisions(0), _backsteps(0), _nogoods(0), _restarts(0), _backjumps(0)
+{
+	_trail.reserve( VARIABLES );
+	_level_starts.reserve( CELLS + 1 );
+}
+
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::assign( const int var, const Value value, const Cause cause, const int index )
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+	const int  cell = var / SIZE, digit = var % SIZE;
+
+	_values[var] = value;
+	_levels[var] = level();
+	_reasons[var].cause = cause;
+	_reasons[var].index = index;
+	_trail.push_back(var);
+
+	if( value == ON )
+	{
+		_placed[cell] = digit + 1;
+		for( int i = 0; i != 3; ++i )
+			_house_digits[ geometry.house_of_cell[cell][i] ] |= (Mask) 1 << digit;
+		--_free;
+	}
+	else
+	{
+		--_cell_counts[cell];
+		for( int i = 0; i != 3; ++i )
+			--_house_counts[ geometry.house_of_cell[cell][i] * SIZE + digit ];
+	}
+}
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::backtrack( const int level )
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+
+	const size_t  end = _level_starts[level + 1];
+	while( _trail.size() != end )
+	{
+		const int  var = _trail.back();
+		const int  cell = var / SIZE, digit = var % SIZE;
+		_trail.pop_back();
+
+		if( _values[var] == ON )
+		{
+			_placed[cell] = 0;
+			for( int i = 0; i != 3; ++i )
+				_house_digits[ geometry.house_of_cell[cell][i] ] &= ~((Mask) 1 << digit);
+			++_free;
+		}
+		else
+		{
+			++_cell_counts[cell];
+			for( int i = 0; i != 3; ++i )
+				++_house_counts[ geometry.house_of_cell[cell][i] * SIZE + digit ];
+		}
+
+		_values[var] = UNKNOWN;
+	}
+
+	//NOTE: the assignments of the levels kept are propagated, but a nogood
+	// of one assignment may still wait at level 0
+	_level_starts.resize( level + 1 );
+	if( _head > _trail.size() )
+		_head = _trail.size();
+}
+
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::propagate()
+{
+	while( _head != _trail.size() )
+	{
+		const int  var = _trail[_head++];
+		if( _values[var] == ON )
+		{
+			if( !propagatePlacement(var) || !propagateNogoods( 2 * var + 1 ) )
+				return false;
+		}
+		else if( !propagateElimination(var) || !propagateNogoods( 2 * var ) )
+			return false;
+	}
+
+	return true;
+}
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::propagatePlacement( const int var )
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+	const int  cell = var / SIZE, digit = var % SIZE;
+
+	//NOTE: the other digits of the cell, then the digit in the peers, an
+	// other placement found among them is the conflict of the two
+	for( int i = 0; i != SIZE + BitGeometry<BOX>::PEERS; ++i )
+	{
+		const int  other = i < SIZE ? cell * SIZE + i : geometry.peers[cell][i - SIZE] * SIZE + digit;
+		if( other == var || _values[other] == OFF )
+			continue;
+
+		if( _values[other] == ON )
+		{
+			_conflict.cause = PLACED;
+			_conflict.index = var;
+			_conflict_var = other;
+			return false;
+		}
+
+		assign( other, OFF, PLACED, var );
+	}
+
+	return true;
+}
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::propagateElimination( const int var )
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+	const int  cell = var / SIZE, digit = var % SIZE;
+
+	// Naked single: the last candidate of the cell
+	if( !_placed[cell] && _cell_counts[cell] <= 1 )
+	{
+		_conflict.cause = CELL;
+		_conflict.index = cell;
+		if( _cell_counts[cell] == 0 )
+			return false;
+
+		for( int d = 0; d != SIZE; ++d )
+			if( _values[ cell * SIZE + d ] == UNKNOWN )
+			{
+				assign( cell * SIZE + d, ON, CELL, cell );
+				break;
+			}
+	}
+
+	// Hidden singles: the last place of the digit in the houses of the cell
+	for( int i = 0; i != 3; ++i )
+	{
+		const int  house = geometry.house_of_cell[cell][i];
+		const int  index = house * SIZE + digit;
+		if( (_house_digits[house] & ((Mask) 1 << digit)) || _house_counts[index] > 1 )
+			continue;
+
+		_conflict.cause = HOUSE;
+		_conflict.index = index;
+		if( _house_counts[index] == 0 )
+			return false;
+
+		for( int j = 0; j != SIZE; ++j )
+		{
+			const int  other = geometry.cells_of_house[house][j] * SIZE + digit;
+			if( _values[other] == UNKNOWN )
+			{
+				assign( other, ON, HOUSE, index );
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::propagateNogoods( const int literal )
+{
+	std::vector<int>  &watches = _watches[literal];
+
+	size_t  kept = 0, i = 0;
+	while( i != watches.size() )
+	{
+		const int  nogood = watches[i++];
+		const int  size = _pool[nogood];
+		int  *literals = &_pool[nogood + 2];
+
+		//NOTE: the false literal goes to the second place, the nogood is
+		// satisfied if the first one holds
+		if( literals[0] == literal )
+			std::swap( literals[0], literals[1] );
+
+		if( valueOf( literals[0] ) == ON )
+		{
+			watches[kept++] = nogood;
+			continue;
+		}
+
+		int  k = 2;
+		while( k != size && valueOf( literals[k] ) == OFF )
+			++k;
+
+		if( k != size )
+		{
+			std::swap( literals[1], literals[k] );
+			_watches[ literals[1] ].push_back(nogood);
+			continue;
+		}
+
+		watches[kept++] = nogood;
+		if( valueOf( literals[0] ) == OFF )
+		{
+			_conflict.cause = NOGOOD;
+			_conflict.index = nogood;
+			while( i != watches.size() )
+				watches[kept++] = watches[i++];
+			watches.resize(kept);
+			return false;
+		}
+
+		assign( literals[0] >> 1, (literals[0] & 1) ? OFF : ON, NOGOOD, nogood );
+	}
+
+	watches.resize(kept);
+	return true;
+}
+
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::variables( const Reason &r, const int var, std::vector<int> &vars ) const
+{
+	const BitGeometry<BOX>  &geometry = BitGeometry<BOX>::instance;
+
+	vars.clear();
+	switch( r.cause )
+	{
+	case DECISION:
+	case FLIPPED:
+		break;
+
+	case PLACED:
+		vars.push_back( r.index );
+		vars.push_back( var );
+		break;
+
+	case CELL:
+		for( int d = 0; d != SIZE; ++d )
+			vars.push_back( r.index * SIZE + d );
+		break;
+
+	case HOUSE:
+		for( int j = 0; j != SIZE; ++j )
+			vars.push_back( geometry.cells_of_house[r.index / SIZE][j] * SIZE + r.index % SIZE );
+		break;
+
+	case NOGOOD:
+		if( r.index >= 0 )
+			for( int k = 0; k != _pool[r.index]; ++k )
+				vars.push_back( _pool[r.index + 2 + k] >> 1 );
+		break;
+	}
+}
+
+template< int BOX >
+int  BasicLearningSolver<BOX>::analyze()
+{
+	_nogood.clear();
+	_nogood.push_back(-1);
+
+	Reason  reason = _conflict;
+	int  var = _conflict_var, found = -1, open = 0;
+	size_t  index = _trail.size();
+
+	//NOTE: the assignments of the current level are resolved in the reverse
+	// order of the trail, until only one of them is left open
+	for( ;; )
+	{
+		variables( reason, var, _clause );
+		for( size_t i = 0; i != _clause.size(); ++i )
+		{
+			const int  v = _clause[i];
+			if( v == found || _seen[v] || _levels[v] == 0 )
+				continue;
+
+			_seen[v] = 1;
+			_activity[ v / SIZE ] += _bump;
+
+			if( _levels[v] == level() )
+				++open;
+			else
+				_nogood.push_back( negation(v) );
+		}
+
+		do
+			found = _trail[--index];
+		while( !_seen[found] );
+
+		_seen[found] = 0;
+		if( --open == 0 )
+			break;
+
+		reason = _reasons[found];
+		var = found;
+	}
+
+	_nogood[0] = negation(found);
+
+	// The jump goes to the latest level of the others, watched second
+	int  jump = 0;
+	for( size_t i = 1; i != _nogood.size(); ++i )
+	{
+		const int  v = _nogood[i] >> 1;
+		_seen[v] = 0;
+		if( _levels[v] > jump )
+		{
+			jump = _levels[v];
+			std::swap( _nogood[1], _nogood[i] );
+		}
+	}
+
+	return jump;
+}
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::learn( std::vector<int> &literals )
+{
+	const int  asserted = literals[0];
+
+	//NOTE: a nogood of one assignment holds from the givens on, it needs
+	// no watches (above a floor it is lost with the level, but it is
+	// learned again when needed)
+	if( literals.size() == 1 )
+	{
+		assign( asserted >> 1, (asserted & 1) ? OFF : ON, NOGOOD, -1 );
+		return;
+	}
+
+	const int  nogood = _pool.size();
+	_pool.push_back( literals.size() );
+	_pool.push_back(0);
+	_pool.insert( _pool.end(), literals.begin(), literals.end() );
+
+	_watches[ literals[0] ].push_back(nogood);
+	_watches[ literals[1] ].push_back(nogood);
+
+	++_learned;
+
+	assign( asserted >> 1, (asserted & 1) ? OFF : ON, NOGOOD, nogood );
+}
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::reduce()
+{
+	// The nogoods which are not the reason of an assignment
+	std::vector<int>  unlocked;
+	for( size_t n = 0; n != _pool.size(); n += 2 + _pool[n] )
+	{
+		const int  first = _pool[n + 2];
+		const Reason  &r = _reasons[first >> 1];
+		const bool  locked = valueOf(first) == ON && r.cause == NOGOOD && r.index == (int) n;
+		if( !locked )
+			unlocked.push_back(n);
+	}
+
+	//NOTE: the longer half is dropped, the sort is stable, so of the same
+	// size the newer ones go first
+	BySize  by_size = { &_pool[0] };
+	std::stable_sort( unlocked.begin(), unlocked.end(), by_size );
+
+	const size_t  drop = std::min( unlocked.size(), (size_t) (_learned - MAX_NOGOODS / 2) );
+	for( size_t i = unlocked.size() - drop; i != unlocked.size(); ++i )
+		_pool[ unlocked[i] + 1 ] = -1;
+
+	// The pool is compacted, the watches and the reasons follow it
+	size_t  end = 0;
+	for( size_t n = 0; n != _pool.size(); n += 2 + _pool[n] )
+	{
+		_watches[ _pool[n + 2] ].clear();
+		_watches[ _pool[n + 3] ].clear();
+	}
+
+	for( size_t n = 0; n != _pool.size(); )
+	{
+		const int  size = _pool[n];
+		if( _pool[n + 1] < 0 )
+		{
+			n += 2 + size;
+			continue;
+		}
+
+		Reason  &r = _reasons[ _pool[n + 2] >> 1 ];
+		if( r.cause == NOGOOD && r.index == (int) n )
+			r.index = end;
+
+		std::copy( _pool.begin() + n, _pool.begin() + n + 2 + size, _pool.begin() + end );
+		_watches[ _pool[end + 2] ].push_back(end);
+		_watches[ _pool[end + 3] ].push_back(end);
+
+		n += 2 + size;
+		end += 2 + size;
+	}
+
+	_pool.resize(end);
+	_learned -= drop;
+}
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::restart()
+{
+	backtrack(_floor);
+	++_restarts;
+	_budget = RESTART_UNIT * luby( ++_luby );
+}
+
+template< int BOX >
+int  BasicLearningSolver<BOX>::selectVariable() const
+{
+	int  best = -1, best_count = SIZE + 1;
+	for( int c = 0; c != CELLS; ++c )
+		if( !_placed[c] && (_cell_counts[c] < best_count || (_cell_counts[c] == best_count && _activity[c] > _activity[best])) )
+		{
+			best = c;
+			best_count = _cell_counts[c];
+		}
+
+	int  d = 0;
+	while( _values[ best * SIZE + d ] != UNKNOWN )
+		++d;
+
+	return best * SIZE + d;
+}
+
+// Undoes the deepest decision not flipped yet, with the levels above it,
+// and tries its opposite, returns false when every decision is flipped
+template< int BOX >
+bool  BasicLearningSolver<BOX>::flip()
+{
+	int  l = level();
+	while( l != 0 && _reasons[ _trail[ _level_starts[l] ] ].cause == FLIPPED )
+		--l;
+
+	if( l == 0 )
+		return false;
+
+	const int  var = _trail[ _level_starts[l] ];
+	backtrack( l - 1 );
+
+	_level_starts.push_back( _trail.size() );
+	assign( var, OFF, FLIPPED, -1 );
+	_floor = l;
+
+	return true;
+}
+
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::init( const TableType& t )
+{
+	for( size_t n = 0; n != _pool.size(); n += 2 + _pool[n] )
+	{
+		_watches[ _pool[n + 2] ].clear();
+		_watches[ _pool[n + 3] ].clear();
+	}
+	_pool.clear();
+	_learned = 0;
+
+	std::fill( _values.begin(), _values.end(), (signed char) UNKNOWN );
+	std::fill( _cell_counts.begin(), _cell_counts.end(), (int) SIZE );
+	std::fill( _house_counts.begin(), _house_counts.end(), (int) SIZE );
+	std::fill( _placed.begin(), _placed.end(), 0 );
+	std::fill( _house_digits.begin(), _house_digits.end(), 0 );
+	std::fill( _activity.begin(), _activity.end(), 0.0 );
+	_free = CELLS;
+
+	_trail.clear();
+	_level_starts.assign( 1, 0 );
+	_head = 0;
+
+	_bump = 1.0;
+	_luby = 1;
+	_budget = RESTART_UNIT * luby(_luby);
+	_decisions = _backsteps = _nogoods = _restarts = _backjumps = 0;
+	_open = false;
+	_floor = 0;
+
+	//NOTE: the givens are the assignments of level 0, a given repeated in
+	// a house is found by the first propagation
+	_consistent = true;
+	for( int y = 0; y != SIZE; ++y )
+		for( int x = 0; x != SIZE; ++x )
+			if( t(x,y) != TableType::empty )
+			{
+				if( t(x,y) < 1 || t(x,y) > SIZE )
+					_consistent = false;
+				else
+					assign( (y * SIZE + x) * SIZE + t(x,y) - 1, ON, DECISION, -1 );
+			}
+}
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::run()
+{
+	_open = false;
+	if( !_consistent )
+	{
+		++_backsteps;
+		return false;
+	}
+
+	_open = search();
+	return _open;
+}
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::next()
+{
+	++_backsteps;
+
+	if( !_open || !flip() )
+	{
+		_open = false;
+		return false;
+	}
+
+	_open = search();
+	return _open;
+}
+
+template< int BOX >
+bool  BasicLearningSolver<BOX>::search()
+{
+	while( true )
+	{
+		if( !propagate() )
+		{
+			++_backsteps;
+
+			//NOTE: no solution is left under the floor, the conflict needs no
+			// nogood, the next decision below is flipped
+			if( level() == _floor )
+			{
+				if( !flip() )
+					return false;
+				continue;
+			}
+
+			//NOTE: a jump below the floor would lose the decisions flipped,
+			// so the nogood asserts its literal at the floor then
+			const int  jump = std::max( analyze(), _floor );
+			_backjumps += level() - 1 - jump;
+			++_nogoods;
+
+			backtrack(jump);
+			learn(_nogood);
+
+			//NOTE: the bump grows instead of the activities decaying
+			_bump /= 0.95;
+			if( _bump > 1e100 )
+			{
+				for( int c = 0; c != CELLS; ++c )
+					_activity[c] *= 1e-100;
+				_bump *= 1e-100;
+			}
+
+			if( _learned >= MAX_NOGOODS )
+				reduce();
+
+			if( --_budget == 0 )
+				restart();
+
+			continue;
+		}
+
+		if( _free == 0 )
+			return true;
+
+		++_decisions;
+		_level_starts.push_back( _trail.size() );
+		assign( selectVariable(), ON, DECISION, -1 );
+	}
+}
+
+template< int BOX >
+void  BasicLearningSolver<BOX>::extractTable( TableType& t ) const
+{
+	for( int y = 0; y != SIZE; ++y )
+		for( int x = 0; x != SIZE; ++x )
+			t(x,y) = _placed[ y * SIZE + x ];
+}
+
+
+template class BasicLearningSolver<2>;
+template class BasicLearningSolver<3>;
+template class BasicLearningSolver<4>;
+template class BasicLearningSolver<5>;
+
+}
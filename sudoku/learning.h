@@ -0,0 +1,201 @@
+#ifndef SUDOKU_LEARNING_H
+#define SUDOKU_LEARNING_H
+
+#include "table.h"
+#include "bitsolver.h"
+#include <stdint.h>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	//NOTE: Nogood learning
+	// Same interface as BitSolver, but a dead end is not just undone. A
+	// variable is a digit of a cell, placed or eliminated, and every
+	// assignment keeps its reason: the placement which eliminated it, the
+	// cell or the house it was the last candidate of, or a nogood. A
+	// conflict is traced back along the reasons of the current decision
+	// level to the first assignment all of them go through (the first
+	// unique implication point), and the assignments of the earlier levels
+	// met on the way make a nogood: a set of placements and eliminations
+	// which cannot hold together. The search jumps back to the latest level
+	// of the nogood, where it forces the opposite of the assignment found,
+	// so the levels in between, and every prefix leading to the same
+	// conflict, are not explored again.
+	//
+	// The nogoods are watched by two of their literals, there are at most
+	// MAX_NOGOODS of them, when they reach it the longer half is dropped.
+	// The search restarts from the givens after RESTART_UNIT times the
+	// terms of the Luby sequence of conflicts, keeping the nogoods. A cell
+	// of the fewest candidates is decided, of them the one which took part
+	// in the most recent conflicts, so a restart takes another way.
+	//
+	// next() keeps no nogood of the solutions: it flips the deepest decision
+	// not flipped yet, as a plain backtracking would. A flipped level is the
+	// floor of the search, the jumps back and the restarts stop there, and
+	// when it runs into a conflict, the next decision below it is flipped.
+	// Instantiated in learning.cc for the same box sizes as BasicTable.
+	template< int BOX >
+	class BasicLearningSolver
+	{
+	public:
+		typedef BasicTable<BOX>  TableType;
+
+		enum {
+			SIZE = BOX * BOX,
+			CELLS = SIZE * SIZE,
+			HOUSES = 3 * SIZE,
+			VARIABLES = CELLS * SIZE,
+			MAX_NOGOODS = 2000,
+			RESTART_UNIT = 100,
+		};
+
+		BasicLearningSolver();
+
+		void  init( const TableType& t );
+
+		bool  run();
+
+		// Continues the search after the solution found by run() or the
+		// previous next(), returns false when there are no more solutions
+		bool  next();
+
+		void  extractTable( TableType& t ) const;
+
+		// A decision is a placement tried, a backstep is a conflict
+		inline int  decisions() const {
+			return _decisions;
+		}
+
+		inline int  backsteps() const {
+			return _backsteps;
+		}
+
+		// The nogoods learned, the restarts, and the levels skipped by the
+		// jumps back, since init()
+		inline int  nogoods() const {
+			return _nogoods;
+		}
+
+		inline int  restarts() const {
+			return _restarts;
+		}
+
+		inline int  backjumps() const {
+			return _backjumps;
+		}
+
+	private:
+		typedef typename BitTraits<BOX>::Mask  Mask;
+
+		//NOTE: Literals
+		// The variable of a digit d of a cell c is c * SIZE + d, it is true
+		// when the digit is placed, false when it is eliminated. A literal
+		// is 2 * variable, or 2 * variable + 1 for its negation, a nogood is
+		// stored as the clause of the negated assignments.
+		enum Value {
+			OFF = -1,
+			UNKNOWN = 0,
+			ON = 1,
+		};
+
+		enum Cause {
+			DECISION,
+			PLACED, // eliminated by the placement of the variable index
+			CELL,   // the last candidate of the cell index
+			HOUSE,  // the last place of a digit in a house, index = house * SIZE + digit
+			NOGOOD, // forced by the nogood at index of the pool, or unit
+			FLIPPED, // the opposite of a decision whose solutions were all found
+		};
+
+		struct Reason
+		{
+			Cause  cause;
+			int  index;
+		};
+
+		std::vector<signed char>  _values;
+		std::vector<int>  _levels;
+		std::vector<Reason>  _reasons;
+		std::vector<char>  _seen;
+
+		// The assignments in order, where each level starts, and the first
+		// one not propagated yet
+		std::vector<int>  _trail;
+		std::vector<int>  _level_starts;
+		size_t  _head;
+
+		// Candidates not eliminated, per cell and per digit of a house
+		std::vector<int>  _cell_counts;
+		std::vector<int>  _house_counts;
+		std::vector<unsigned char>  _placed; // digit + 1, or 0
+		std::vector<Mask>  _house_digits;
+		int  _free;
+
+		//NOTE: Nogood pool
+		// A nogood is its size, a flag set when reduce() drops it, then its
+		// literals, the first two are watched. The watches of a literal are
+		// the nogoods to visit when it becomes false.
+		std::vector<int>  _pool;
+		std::vector< std::vector<int> >  _watches;
+		int  _learned; // nogoods in the pool
+
+		std::vector<double>  _activity; // of the cells
+		double  _bump;
+
+		bool  _consistent;
+		bool  _open; // a solution was found, next() may go on
+		int  _floor; // the deepest flipped level, 0 before next()
+
+		Reason  _conflict;
+		int  _conflict_var;
+		std::vector<int>  _clause;
+		std::vector<int>  _nogood;
+
+		int  _luby;
+		int  _budget; // conflicts left until the next restart
+
+		// statistical info
+		int  _decisions;
+		int  _backsteps;
+		int  _nogoods;
+		int  _restarts;
+		int  _backjumps;
+
+		inline int  level() const {
+			return (int) _level_starts.size() - 1;
+		}
+
+		inline int  valueOf( const int literal ) const {
+			const int  v = _values[literal >> 1];
+			return (literal & 1) ? -v : v;
+		}
+
+		// The literal of the clause negating the current value of the variable
+		inline int  negation( const int var ) const {
+			return 2 * var + (_values[var] == ON ? 1 : 0);
+		}
+
+		void  assign( const int var, const Value value, const Cause cause, const int index );
+		void  backtrack( const int level );
+
+		bool  propagate();
+		bool  propagatePlacement( const int var );
+		bool  propagateElimination( const int var );
+		bool  propagateNogoods( const int literal );
+
+		void  variables( const Reason &r, const int var, std::vector<int> &vars ) const;
+		int  analyze();
+		void  learn( std::vector<int> &literals );
+		void  reduce();
+		void  restart();
+		int  selectVariable() const;
+		bool  flip();
+
+		bool  search();
+	};
+
+	typedef BasicLearningSolver<3>  LearningSolver;
+}
+#endif
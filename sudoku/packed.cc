@@ -0,0 +1,96 @@
+#include "packed.h"
+#include <cstring>
+
+
+namespace sudoku {
+
+namespace {
+
+const unsigned char  magic[4] = { 'S', 'D', 'K', 'P' };
+
+}
+
+
+void  PackedFormat::writeHeader( unsigned char *header )
+{
+	memset( header, 0, HEADER_SIZE );
+	memcpy( header, magic, 4 );
+	header[4] = VERSION;
+	header[5] = 3;
+	header[6] = RECORD_SIZE & 0xFF;
+	header[7] = RECORD_SIZE >> 8;
+}
+
+bool  PackedFormat::checkHeader( const unsigned char *header, const size_t size )
+{
+	return size >= HEADER_SIZE && memcmp( header, magic, 4 ) == 0 && header[4] == VERSION && header[5] == 3
+		&& (header[6] | header[7] << 8) == RECORD_SIZE;
+}
+
+bool  PackedFormat::encode( const Table &t, unsigned char *record )
+{
+	unsigned  bits = 0;
+	int  count = 0;
+
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; x += 3 )
+		{
+			const int  a = t(x,y), b = t(x+1,y), c = t(x+2,y);
+			if( (unsigned) a > 9 || (unsigned) b > 9 || (unsigned) c > 9 )
+				return false;
+
+			bits |= (a * 100 + b * 10 + c) << count;
+			for( count += 10; count >= 8; count -= 8, bits >>= 8 )
+				*record++ = bits & 0xFF;
+		}
+
+	*record = bits;
+	return true;
+}
+
+bool  PackedFormat::decode( const unsigned char *record, Table &t )
+{
+	unsigned  bits = 0;
+	int  count = 0;
+
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; x += 3 )
+		{
+			for( ; count < 10; count += 8 )
+				bits |= *record++ << count;
+
+			const unsigned  group = bits & 0x3FF;
+			bits >>= 10;
+			count -= 10;
+
+			if( group > 999 )
+				return false;
+
+			t(x,y) = group / 100;
+			t(x+1,y) = group / 10 % 10;
+			t(x+2,y) = group % 10;
+		}
+
+	return true;
+}
+
+
+PackedWriter::PackedWriter( std::ostream &os ) : _os(os), _count(0)
+{
+	unsigned char  header[PackedFormat::HEADER_SIZE];
+	PackedFormat::writeHeader(header);
+	_os.write( (const char*) header, sizeof(header) );
+}
+
+bool  PackedWriter::write( const Table &t )
+{
+	unsigned char  record[PackedFormat::RECORD_SIZE];
+	if( !PackedFormat::encode( t, record ) )
+		return false;
+
+	_os.write( (const char*) record, sizeof(record) );
+	++_count;
+	return true;
+}
+
+}
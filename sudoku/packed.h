@@ -0,0 +1,54 @@
+#ifndef SUDOKU_PACKED_H
+#define SUDOKU_PACKED_H
+
+#include "table.h"
+#include <cstddef>
+
+
+
+namespace sudoku
+{
+	//NOTE: Packed corpus format
+	// A 16 byte header: the "SDKP" magic, the format version, the box size
+	// (3 for 9x9 tables), the record size as a little-endian 16-bit integer
+	// and 8 reserved zero bytes. Then fixed-size records, one per table, so
+	// the n-th table is at HEADER_SIZE + n * RECORD_SIZE. A record packs the
+	// cells row by row in groups of three, each group as the 10-bit number
+	// 100*a + 10*b + c, least significant bit first (270 bits in 34 bytes).
+	class PackedFormat
+	{
+	public:
+		enum {
+			VERSION = 1,
+			HEADER_SIZE = 16,
+			RECORD_SIZE = 34,
+		};
+
+		static void  writeHeader( unsigned char *header );
+		static bool  checkHeader( const unsigned char *header, const size_t size );
+
+		// Returns false if some cell can not be packed
+		static bool  encode( const Table &t, unsigned char *record );
+		// Returns false if the record is corrupt
+		static bool  decode( const unsigned char *record, Table &t );
+	};
+
+
+	class PackedWriter
+	{
+	public:
+		// Writes the header to the stream
+		explicit PackedWriter( std::ostream &os );
+
+		bool  write( const Table &t );
+
+		inline long  count() const {
+			return _count;
+		}
+
+	private:
+		std::ostream  &_os;
+		long  _count;
+	};
+}
+#endif
@@ -0,0 +1,177 @@
+#include "parallel.h"
+
+
+namespace sudoku {
+
+ParallelSolver::ParallelSolver( const int workers )
+	: _solvers( workers < 1 ? 1 : workers ), _waiting(0), _done(false), _winner(-1), _running(0)
+{
+	pthread_mutex_init( &_lock, 0 );
+	pthread_cond_init( &_changed, 0 );
+
+	//NOTE: a single worker has no one to share with
+	if( _solvers.size() > 1 )
+		for( size_t i = 0; i != _solvers.size(); ++i )
+			_solvers[i].share(this);
+}
+
+ParallelSolver::~ParallelSolver()
+{
+	pthread_cond_destroy( &_changed );
+	pthread_mutex_destroy( &_lock );
+}
+
+bool  ParallelSolver::stopped() const
+{
+	return __atomic_load_n( &_done, __ATOMIC_RELAXED );
+}
+
+bool  ParallelSolver::hungry() const
+{
+	return __atomic_load_n( &_waiting, __ATOMIC_RELAXED ) > 0;
+}
+
+void  ParallelSolver::share( const Solver::Branch &b )
+{
+	pthread_mutex_lock( &_lock );
+	_branches.push_back(b);
+	__atomic_sub_fetch( &_waiting, 1, __ATOMIC_RELAXED );
+	pthread_cond_signal( &_changed );
+	pthread_mutex_unlock( &_lock );
+}
+
+bool  ParallelSolver::take( std::vector<Solver::Branch> &mine )
+{
+	pthread_mutex_lock( &_lock );
+
+	__atomic_add_fetch( &_waiting, 1, __ATOMIC_RELAXED );
+	while( _branches.empty() && !_done )
+	{
+		// Everyone waits, so the whole tree is searched
+		if( _waiting == _running )
+		{
+			__atomic_store_n( &_done, true, __ATOMIC_RELAXED );
+			pthread_cond_broadcast( &_changed );
+			break;
+		}
+
+		pthread_cond_wait( &_changed, &_lock );
+	}
+
+	const bool  found = !_done && !_branches.empty();
+	if( found )
+	{
+		mine.clear();
+		mine.push_back( _branches.back() );
+		_branches.pop_back();
+	}
+	else
+		__atomic_sub_fetch( &_waiting, 1, __ATOMIC_RELAXED );
+
+	pthread_mutex_unlock( &_lock );
+	return found;
+}
+
+void  ParallelSolver::finish( const int worker )
+{
+	pthread_mutex_lock( &_lock );
+	if( !_done )
+	{
+		__atomic_store_n( &_done, true, __ATOMIC_RELAXED );
+		_winner = worker;
+	}
+	pthread_cond_broadcast( &_changed );
+	pthread_mutex_unlock( &_lock );
+}
+
+void  ParallelSolver::work( const int worker )
+{
+	Solver  &solver = _solvers[worker];
+
+	std::vector<Solver::Branch>  mine;
+	while( take(mine) )
+		if( solver.explore( mine.back() ) )
+			finish(worker);
+}
+
+void*  ParallelSolver::start( void *worker )
+{
+	Worker  *w = (Worker*) worker;
+	w->owner->work( w->index );
+	return 0;
+}
+
+
+void  ParallelSolver::init( const Table& t )
+{
+	for( size_t i = 0; i != _solvers.size(); ++i )
+		_solvers[i].init(t);
+}
+
+bool  ParallelSolver::run()
+{
+	const int  n = workers();
+
+	_branches.clear();
+	__atomic_store_n( &_waiting, 0, __ATOMIC_RELAXED );
+	__atomic_store_n( &_done, false, __ATOMIC_RELAXED );
+	_winner = -1;
+
+	//NOTE: a worker whose thread fails to start is left out, the others
+	// search the table, the calling thread alone if need be. The count is
+	// set before any thread starts, and lowered under the lock.
+	_running = n;
+
+	std::vector<pthread_t>  threads( n );
+	std::vector<Worker>  workers( n );
+	std::vector<char>  started( n, 0 );
+	for( int i = 1; i != n; ++i )
+	{
+		workers[i].owner = this;
+		workers[i].index = i;
+		started[i] = pthread_create( &threads[i], 0, start, &workers[i] ) == 0;
+		if( !started[i] )
+		{
+			pthread_mutex_lock( &_lock );
+			--_running;
+			pthread_cond_broadcast( &_changed );
+			pthread_mutex_unlock( &_lock );
+		}
+	}
+
+	// The calling thread searches the table, then helps with the branches
+	// given away meanwhile
+	if( _solvers[0].run() )
+		finish(0);
+	if( n > 1 )
+		work(0);
+
+	for( int i = 1; i != n; ++i )
+		if( started[i] )
+			pthread_join( threads[i], 0 );
+
+	return _winner != -1;
+}
+
+void  ParallelSolver::extractTable( Table& t ) const
+{
+	_solvers[ _winner == -1 ? 0 : _winner ].extractTable(t);
+}
+
+int  ParallelSolver::decisions() const
+{
+	int  sum = 0;
+	for( size_t i = 0; i != _solvers.size(); ++i )
+		sum += _solvers[i].decisions();
+	return sum;
+}
+
+int  ParallelSolver::backsteps() const
+{
+	int  sum = 0;
+	for( size_t i = 0; i != _solvers.size(); ++i )
+		sum += _solvers[i].backsteps();
+	return sum;
+}
+
+}
@@ -0,0 +1,81 @@
+#ifndef SUDOKU_PARALLEL_H
+#define SUDOKU_PARALLEL_H
+
+#include "solver.h"
+#include <pthread.h>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	//NOTE: Parallel search of one table
+	// Every worker has its own Solver. The calling thread starts the search
+	// of the table, the others wait for work. While some of them wait, the
+	// searching ones give away the alternatives of their next decision (a
+	// Solver::Branch), which a waiting worker takes over and searches, and
+	// gives away parts of in turn. The first solution found stops the rest.
+	// The decisions and backsteps are the sums of the workers. They are
+	// close to the sequential ones, but not always the same: a branch is
+	// searched on a copy of the cube, not an unwound one, so the queue of
+	// the areas may break the ties of the potentials differently.
+	class ParallelSolver : private Solver::Sharing
+	{
+	public:
+		typedef Table  TableType;
+
+		explicit ParallelSolver( const int workers );
+		~ParallelSolver();
+
+		inline int  workers() const {
+			return (int) _solvers.size();
+		}
+
+		void  init( const Table& t );
+		bool  run();
+		void  extractTable( Table& t ) const;
+
+		int  decisions() const;
+		int  backsteps() const;
+
+	private:
+		struct Worker
+		{
+			ParallelSolver  *owner;
+			int  index;
+		};
+
+		std::vector<Solver>  _solvers;
+		std::vector<Solver::Branch>  _branches;
+		pthread_mutex_t  _lock;
+		pthread_cond_t  _changed;
+
+		//NOTE: Polled flags
+		// _waiting (the waiting workers less the branches waiting for them)
+		// and _done are written under the lock, but polled without it by the
+		// searches, so every write and every unlocked read is a relaxed
+		// __atomic builtin. No ordering is relied on: a poll only tells a
+		// search to share a branch, which takes the lock, or to give up, and
+		// a stale value just delays that until the next decision. What the
+		// workers exchange (the branches, the winner) is read under the lock.
+		int  _waiting;
+		bool  _done;
+		int  _winner;
+		int  _running; // the workers whose thread was started
+
+		// Takes a branch to search, or returns false when the search is over
+		bool  take( std::vector<Solver::Branch> &mine );
+		void  finish( const int worker );
+		void  work( const int worker );
+
+		static void*  start( void *worker );
+
+		virtual bool  stopped() const;
+		virtual bool  hungry() const;
+		virtual void  share( const Solver::Branch &b );
+
+		ParallelSolver( const ParallelSolver& );
+		ParallelSolver&  operator= ( const ParallelSolver& );
+	};
+}
+#endif
@@ -0,0 +1,172 @@
+#include "reader.h"
+#include "packed.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace sudoku {
+
+MappedCorpus::MappedCorpus( const char *path, const Format f )
+	: _format(f), _open(false), _begin(0), _end(0), _pos(0), _skipped(0)
+{
+	const int  fd = path ? open( path, O_RDONLY ) : STDIN_FILENO;
+	if( fd == -1 )
+		return;
+
+	struct stat  st;
+	if( fstat( fd, &st ) == 0 && S_ISREG(st.st_mode) )
+	{
+		if( st.st_size == 0 )
+			_open = true;
+		else
+		{
+			void  *m = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+			if( m != MAP_FAILED )
+			{
+				madvise( m, st.st_size, MADV_SEQUENTIAL );
+				_begin = _pos = (const char*) m;
+				_end = _begin + st.st_size;
+				_open = true;
+			}
+		}
+	}
+
+	//NOTE: the mapping stays valid after closing the file
+	if( path )
+		close(fd);
+
+	if( _open && _format == PACKED )
+	{
+		if( PackedFormat::checkHeader( (const unsigned char*) _begin, size() ) )
+			_pos = _begin + PackedFormat::HEADER_SIZE;
+		else
+			_open = false;
+	}
+}
+
+MappedCorpus::~MappedCorpus()
+{
+	if( _begin )
+		munmap( (void*) _begin, _end - _begin );
+}
+
+template< int BOX >
+bool  MappedCorpus::next( BasicTable<BOX> &t )
+{
+	switch( _format )
+	{
+	case TABLES:
+		return nextTable(t);
+
+	case LINES:
+		return nextLine(t);
+
+	default:
+		return nextRecord(t);
+	}
+}
+
+size_t  MappedCorpus::records() const
+{
+	return (size() - PackedFormat::HEADER_SIZE) / PackedFormat::RECORD_SIZE;
+}
+
+void  MappedCorpus::seek( const size_t record )
+{
+	_pos = _begin + PackedFormat::HEADER_SIZE + (record < records() ? record : records()) * PackedFormat::RECORD_SIZE;
+}
+
+template< int BOX >
+bool  MappedCorpus::nextTable( BasicTable<BOX> &t )
+{
+	const int  SIZE = BOX * BOX;
+	const char  *p = _pos;
+	int  x = 0, y = 0;
+
+	while( p != _end )
+	{
+		unsigned  d = (unsigned char) *p++ - '0';
+		if( d > 9 )
+			continue;
+
+		if( SIZE > 9 )
+			for( unsigned n; p != _end && (n = (unsigned char) *p - '0') <= 9; ++p )
+				d = (d < 1000) ? d * 10 + n : d;
+
+		t(x,y) = d;
+		if( ++x == SIZE )
+		{
+			x = 0;
+			if( ++y == SIZE )
+				break;
+		}
+	}
+
+	_pos = p;
+	if( y == SIZE )
+		return true;
+
+	// A truncated table at the end of the corpus
+	if( x != 0 || y != 0 )
+		++_skipped;
+
+	return false;
+}
+
+template< int BOX >
+bool  MappedCorpus::nextLine( BasicTable<BOX> &t )
+{
+	while( _pos != _end )
+	{
+		const char  *line = _pos;
+		const char  *eol = (const char*) memchr( line, '\n', _end - line );
+		if( eol == 0 )
+			eol = _end;
+
+		_pos = (eol == _end) ? _end : eol + 1;
+
+		if( eol == line || *line == '#' || (eol - line == 1 && *line == '\r') )
+			continue;
+
+		if( readLine( line, eol - line, t ) )
+			return true;
+
+		++_skipped;
+	}
+
+	return false;
+}
+
+bool  MappedCorpus::nextRecord( Table &t )
+{
+	while( _end - _pos >= PackedFormat::RECORD_SIZE )
+	{
+		const unsigned char  *record = (const unsigned char*) _pos;
+		_pos += PackedFormat::RECORD_SIZE;
+
+		if( PackedFormat::decode( record, t ) )
+			return true;
+
+		++_skipped;
+	}
+
+	// A truncated record at the end of the corpus
+	if( _pos != _end )
+	{
+		++_skipped;
+		_pos = _end;
+	}
+
+	return false;
+}
+
+
+template bool  MappedCorpus::next( BasicTable<2> &t );
+template bool  MappedCorpus::next( BasicTable<3> &t );
+template bool  MappedCorpus::next( BasicTable<4> &t );
+template bool  MappedCorpus::next( BasicTable<5> &t );
+
+}
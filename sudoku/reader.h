@@ -0,0 +1,80 @@
+#ifndef SUDOKU_READER_H
+#define SUDOKU_READER_H
+
+#include "table.h"
+#include <cstddef>
+
+
+
+namespace sudoku
+{
+	//NOTE: Memory-mapped corpus
+	// The whole corpus file is mapped into memory, and the tables are parsed
+	// straight from the mapped bytes, without iostreams or extra copies.
+	// TABLES: the table format of the README, every 81 digits make a table
+	//         and any other character is skipped (so one digit is one cell).
+	//         Above 9x9 a cell is a run of digits instead.
+	// LINES:  the one-line format, malformed lines are skipped and counted.
+	// PACKED: the binary PackedFormat, which can also be read at random.
+	//         It holds 9x9 tables only.
+	class MappedCorpus
+	{
+	public:
+		enum Format {
+			TABLES,
+			LINES,
+			PACKED,
+		};
+
+		// Maps the file, or the standard input if path is 0
+		MappedCorpus( const char *path, const Format f );
+		~MappedCorpus();
+
+		inline bool  isOpen() const {
+			return _open;
+		}
+
+		// Parses the next table, returns false at the end of the corpus
+		template< int BOX >
+		bool  next( BasicTable<BOX> &t );
+
+		inline size_t  size() const {
+			return _end - _begin;
+		}
+
+		inline size_t  position() const {
+			return _pos - _begin;
+		}
+
+		inline long  skipped() const {
+			return _skipped;
+		}
+
+		// Number of records in a PACKED corpus
+		size_t  records() const;
+
+		// Moves to the given record of a PACKED corpus
+		void  seek( const size_t record );
+
+	private:
+		Format  _format;
+		bool  _open;
+		const char  *_begin, *_end, *_pos;
+		long  _skipped;
+
+		template< int BOX >
+		bool  nextTable( BasicTable<BOX> &t );
+		template< int BOX >
+		bool  nextLine( BasicTable<BOX> &t );
+		bool  nextRecord( Table &t );
+
+		template< int BOX >
+		inline bool  nextRecord( BasicTable<BOX>& ) {
+			return false;
+		}
+
+		MappedCorpus( const MappedCorpus& );
+		MappedCorpus&  operator= ( const MappedCorpus& );
+	};
+}
+#endif
@@ -0,0 +1,311 @@
+#include "solver.h"
+#include "bits/geometry.h"
+
+
+namespace sudoku {
+
+namespace {
+
+typedef uint16_t  Bits;
+
+// The cells of the houses, rows, columns, then boxes, as y * 9 + x
+typedef BitGeometry<3>  Houses;
+
+inline int  count( const Bits b )
+{
+	return __builtin_popcount(b);
+}
+
+//NOTE: Subsets
+// The lines of a plane hold 9 bits each. If the bits of k lines (2 to k bits
+// each) are all among k positions, these positions are taken by the k lines,
+// so their bits are removed from the other lines. A naked subset has the
+// cells of a house as lines and their digits as bits, a hidden one the
+// digits as lines and their cells as bits, an X-wing the rows (or columns)
+// of a digit as lines and its places in them as bits.
+void  findSubsets( const Bits *lines, const int k, const int first, const int chosen, const Bits united, const int taken,
+	Bits *remove )
+{
+	if( count(united) > k )
+		return;
+
+	if( chosen == k )
+	{
+		if( count(united) == k )
+			for( int i = 0; i != 9; ++i )
+				if( !(taken & (1 << i)) )
+					remove[i] |= lines[i] & united;
+		return;
+	}
+
+	for( int i = first; i != 9; ++i )
+		if( count(lines[i]) >= 2 && count(lines[i]) <= k )
+			findSubsets( lines, k, i + 1, chosen + 1, united | lines[i], taken | (1 << i), remove );
+}
+
+inline void  findSubsets( const Bits *lines, const int k, Bits *remove )
+{
+	for( int i = 0; i != 9; ++i )
+		remove[i] = 0;
+
+	findSubsets( lines, k, 0, 0, 0, 0, remove );
+}
+
+//NOTE: Locked candidates
+// The lines of the plane are the rows (or columns) of a digit, the bits its
+// places. If the places of a box are all in one line, the digit is removed
+// from the rest of the line (pointing), and if the places of a line are all
+// in one box, it is removed from the rest of the box (claiming).
+void  findLocked( const Bits *lines, Bits *remove )
+{
+	for( int i = 0; i != 9; ++i )
+		remove[i] = 0;
+
+	for( int band = 0; band != 3; ++band )
+		for( int stack = 0; stack != 3; ++stack )
+		{
+			const Bits  box = 7 << (stack * 3);
+
+			int  used = 0;
+			for( int l = band * 3; l != band * 3 + 3; ++l )
+				if( lines[l] & box )
+					++used;
+
+			for( int l = band * 3; l != band * 3 + 3; ++l )
+			{
+				if( !(lines[l] & box) )
+					continue;
+
+				if( used == 1 )
+					remove[l] |= lines[l] & ~box;
+
+				if( !(lines[l] & ~box) )
+					for( int o = band * 3; o != band * 3 + 3; ++o )
+						if( o != l )
+							remove[o] |= lines[o] & box;
+			}
+		}
+}
+
+}
+
+
+const char*  Solver::ruleName( const Rule r )
+{
+	static const char  *names[RULES] = { "locked", "naked-pairs", "naked-triples", "hidden-pairs", "hidden-triples", "x-wing" };
+	return names[r];
+}
+
+void  Solver::readCandidates( Candidates &c )
+{
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; ++x )
+		{
+			Bits  m = 0;
+			for( int v = 0; v != 9; ++v )
+			{
+				const Cube::CellState  s = _cube.cell( x, y, v ).state();
+				if( s == Cube::FREE || s == Cube::WEAK_UNOBTAINABLE )
+					m |= 1 << v;
+			}
+			c[y][x] = m;
+		}
+}
+
+int  Solver::lockedCandidates( Candidates &c )
+{
+	int  eliminated = 0;
+	for( int v = 0; v != 9; ++v )
+	{
+		const Bits  bit = 1 << v;
+		Bits  rows[9], columns[9], remove[9];
+		for( int i = 0; i != 9; ++i )
+			rows[i] = columns[i] = 0;
+
+		for( int y = 0; y != 9; ++y )
+			for( int x = 0; x != 9; ++x )
+				if( c[y][x] & bit )
+				{
+					rows[y] |= 1 << x;
+					columns[x] |= 1 << y;
+				}
+
+		findLocked( rows, remove );
+		for( int y = 0; y != 9; ++y )
+			for( int x = 0; x != 9; ++x )
+				if( remove[y] & (1 << x) && c[y][x] & bit )
+				{
+					_cube.cell( x, y, v ).markUnobtainable();
+					c[y][x] &= ~bit;
+					++eliminated;
+				}
+
+		findLocked( columns, remove );
+		for( int x = 0; x != 9; ++x )
+			for( int y = 0; y != 9; ++y )
+				if( remove[x] & (1 << y) && c[y][x] & bit )
+				{
+					_cube.cell( x, y, v ).markUnobtainable();
+					c[y][x] &= ~bit;
+					++eliminated;
+				}
+	}
+
+	return eliminated;
+}
+
+int  Solver::nakedSubsets( Candidates &c, const int size )
+{
+	const Houses  &houses = Houses::instance;
+
+	int  eliminated = 0;
+	for( int h = 0; h != 27; ++h )
+	{
+		Bits  lines[9], remove[9];
+		for( int i = 0; i != 9; ++i )
+		{
+			const int  cell = houses.cells_of_house[h][i];
+			lines[i] = c[cell / 9][cell % 9];
+		}
+
+		findSubsets( lines, size, remove );
+		for( int i = 0; i != 9; ++i )
+			for( int v = 0; v != 9; ++v )
+				if( remove[i] & (1 << v) )
+				{
+					const int  cell = houses.cells_of_house[h][i];
+					_cube.cell( cell % 9, cell / 9, v ).markUnobtainable();
+					c[cell / 9][cell % 9] &= ~(1 << v);
+					++eliminated;
+				}
+	}
+
+	return eliminated;
+}
+
+int  Solver::hiddenSubsets( Candidates &c, const int size )
+{
+	const Houses  &houses = Houses::instance;
+
+	int  eliminated = 0;
+	for( int h = 0; h != 27; ++h )
+	{
+		Bits  lines[9], remove[9];
+		for( int v = 0; v != 9; ++v )
+		{
+			lines[v] = 0;
+			for( int i = 0; i != 9; ++i )
+			{
+				const int  cell = houses.cells_of_house[h][i];
+				if( c[cell / 9][cell % 9] & (1 << v) )
+					lines[v] |= 1 << i;
+			}
+		}
+
+		findSubsets( lines, size, remove );
+		for( int v = 0; v != 9; ++v )
+			for( int i = 0; i != 9; ++i )
+				if( remove[v] & (1 << i) )
+				{
+					const int  cell = houses.cells_of_house[h][i];
+					_cube.cell( cell % 9, cell / 9, v ).markUnobtainable();
+					c[cell / 9][cell % 9] &= ~(1 << v);
+					++eliminated;
+				}
+	}
+
+	return eliminated;
+}
+
+int  Solver::xWing( Candidates &c )
+{
+	int  eliminated = 0;
+	for( int v = 0; v != 9; ++v )
+	{
+		const Bits  bit = 1 << v;
+		Bits  rows[9], columns[9], remove[9];
+		for( int i = 0; i != 9; ++i )
+			rows[i] = columns[i] = 0;
+
+		for( int y = 0; y != 9; ++y )
+			for( int x = 0; x != 9; ++x )
+				if( c[y][x] & bit )
+				{
+					rows[y] |= 1 << x;
+					columns[x] |= 1 << y;
+				}
+
+		findSubsets( rows, 2, remove );
+		for( int y = 0; y != 9; ++y )
+			for( int x = 0; x != 9; ++x )
+				if( remove[y] & (1 << x) && c[y][x] & bit )
+				{
+					_cube.cell( x, y, v ).markUnobtainable();
+					c[y][x] &= ~bit;
+					++eliminated;
+				}
+
+		findSubsets( columns, 2, remove );
+		for( int x = 0; x != 9; ++x )
+			for( int y = 0; y != 9; ++y )
+				if( remove[x] & (1 << y) && c[y][x] & bit )
+				{
+					_cube.cell( x, y, v ).markUnobtainable();
+					c[y][x] &= ~bit;
+					++eliminated;
+				}
+	}
+
+	return eliminated;
+}
+
+bool  Solver::applyRules()
+{
+	Candidates  c;
+	readCandidates(c);
+
+	for( int r = 0; r != RULES; ++r )
+	{
+		if( !enabled( (Rule) r ) )
+			continue;
+
+		int  eliminated = 0;
+		switch( r )
+		{
+		case LOCKED_CANDIDATES:
+			eliminated = lockedCandidates(c);
+			break;
+
+		case NAKED_PAIRS:
+			eliminated = nakedSubsets( c, 2 );
+			break;
+
+		case NAKED_TRIPLES:
+			eliminated = nakedSubsets( c, 3 );
+			break;
+
+		case HIDDEN_PAIRS:
+			eliminated = hiddenSubsets( c, 2 );
+			break;
+
+		case HIDDEN_TRIPLES:
+			eliminated = hiddenSubsets( c, 3 );
+			break;
+
+		case X_WING:
+			eliminated = xWing(c);
+			break;
+		}
+
+		//NOTE: the singles are cheaper, so they are looked for again first
+		if( eliminated != 0 )
+		{
+			_eliminations[r] += eliminated;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+}
@@ -0,0 +1,40 @@
+#ifndef SUDOKU_SOLUTIONS_H
+#define SUDOKU_SOLUTIONS_H
+
+
+
+namespace sudoku
+{
+	//NOTE: Solution counting
+	// For every engine with run() and next(), after its init(). The count
+	// stops at limit (0 for no limit), so with limit 2 the result tells
+	// whether the solution is unique. Every solution found is passed to
+	// visit(solver) before the search goes on, e.g. to extract it.
+	template< typename SOLVER, typename VISITOR >
+	int  countSolutions( SOLVER &solver, const int limit, VISITOR &visit )
+	{
+		int  count = 0;
+		for( bool found = solver.run(); found; found = solver.next() )
+		{
+			visit(solver);
+			if( ++count == limit )
+				break;
+		}
+
+		return count;
+	}
+
+	struct IgnoreSolutions
+	{
+		template< typename SOLVER >
+		inline void  operator() ( const SOLVER& ) const  {}
+	};
+
+	template< typename SOLVER >
+	int  countSolutions( SOLVER &solver, const int limit )
+	{
+		IgnoreSolutions  ignore;
+		return countSolutions( solver, limit, ignore );
+	}
+}
+#endif
@@ -3,18 +3,11 @@
 
 #include "table.h"
 #include "bits/matrix.h"
-#include <list>
-#include <deque>
-#include <stack>
+#include <vector>
+#include <stdint.h>
 #include <string>
 #include <stdexcept>
 
-#ifdef DEBUG
-#define DEBUG_THROWING  throw(InconsistencyError)
-#else
-#define DEBUG_THROWING
-#endif
-
 
 
 namespace sudoku
@@ -22,6 +15,49 @@ namespace sudoku
     class Solver
     {
 	public:
+		//NOTE: the cube is built for 9x9 tables only
+		typedef Table  TableType;
+
+		// Access to the internals for the benchmarks, defined by sdk-bench
+		struct Probe;
+		friend struct Probe;
+
+		// An open decision of the search: the alternatives left in an area,
+		// with the cube they are tried on. Another solver can take it over
+		// with explore(), so the search of one table can be split between
+		// threads (see ParallelSolver).
+		struct Branch;
+
+		// Takes the branches the search gives away
+		class Sharing
+		{
+		public:
+			virtual ~Sharing()  {}
+
+			// Polled at every decision, so they must be cheap: whether the
+			// search should give up, and whether a branch is wanted
+			virtual bool  stopped() const = 0;
+			virtual bool  hungry() const = 0;
+
+			virtual void  share( const Branch &b ) = 0;
+		};
+
+		//NOTE: Propagation rules
+		// Deductions beyond the singles, tried by deterministicMove() when no
+		// single is left, so the search branches only when none of them can
+		// eliminate a candidate either. They are all off by default.
+		enum Rule {
+			LOCKED_CANDIDATES, // pointing and claiming
+			NAKED_PAIRS,
+			NAKED_TRIPLES,
+			HIDDEN_PAIRS,
+			HIDDEN_TRIPLES,
+			X_WING,
+			RULES,
+		};
+
+		// Thrown only by DEBUG builds, when the internal state of the solver
+		// turns out to be inconsistent.
 		class InconsistencyError : public std::exception
 		{
 		public:
@@ -55,6 +91,12 @@ namespace sudoku
 				WEAK_UNOBTAINABLE,
 			};
 
+			//NOTE: Compact layout
+			// Every slot of the cube (cell states, potentials up to 90, the
+			// candidate index of the areas, flags) fits a byte, so the state
+			// of a solve is about 3.5 KB and stays in L1 with the trail.
+			typedef int8_t  Slot;
+
 			class Cell
 			{
 				friend class Cube;
@@ -77,18 +119,18 @@ namespace sudoku
 
 
 				inline State  state() const {
-					return (State) _owner->_cells[_index.address()];
+					return (State) _owner->_cells[_address];
 				}
 
-				void  markOccupied()  DEBUG_THROWING;
+				void  markOccupied();
 				void  markUnobtainable();
 				void  markWeakUnobtainable();
 
 			private:
 				Cube  *_owner;
-				Index  _index;
+				int  _address;
 
-				inline Cell( Cube *o, const Index &i ) : _owner(o), _index(i)  {}
+				inline Cell( Cube *o, const int a ) : _owner(o), _address(a)  {}
 			};
 
 			class Area
@@ -130,26 +172,60 @@ namespace sudoku
 					return _index;
 				}
 
-				int  potential() const;
+				inline int  potential() const {
+					return _owner->_potentials[_address];
+				}
+
 				int  value() const;
 
 
-				enum NoPossibleCell {
-					NO_POSSIBLE_CELL,
-				};
+				// Steps to the next possible cell of the area, returns false
+				// if there is none left.
+				bool  IndexOfNextPossibileCell( Cell::Index &i );
 
-				Cell::Index  IndexOfNextPossibileCell() throw(NoPossibleCell);
+				// The same, with the address of the cell
+				bool  nextPossibleCell( int &cell );
 
 			private:
 				Cube  *_owner;
 				Index  _index;
+				int  _address;
+
+				inline Area( Cube *o, const Index &i ) : _owner(o), _index(i), _address( i.address() )  {}
+			};
+
 
-				inline Area( Cube *o, const Index &i ) : _owner(o), _index(i)  {}
+			//NOTE: Undo trail
+			// Every modification of the cube can be recorded as the old value of
+			// the modified slot. Unwinding the trail backwards restores the cube,
+			// so backtracking costs only as much as the decision changed.
+			struct Change
+			{
+				Slot  *slot;
+				int16_t  area; // address of the queued area the slot belongs to, or -1
+				Slot  old;
 			};
 
+			typedef std::vector<Change>  Trail;
+
 
 			Cube();
 
+			void  reset();
+
+			inline void  record( Trail *t ) {
+				_trail = t;
+			}
+
+			void  unwind( const size_t mark );
+
+			// The areas which are not completed yet, by their potential
+			inline bool  allAreasCompleted() const {
+				return (_nonempty_buckets[0] | _nonempty_buckets[1]) == 0;
+			}
+
+			Area::Index  mostConstrainedArea() const;
+
 			inline Area  area( const Area::Index &i ) {
 				return Area( this, i );
 			}
@@ -170,8 +246,12 @@ namespace sudoku
 				return area( Area::Index(Area::SUBTABLE,f,s) );
 			}
 
+			inline Cell  cell( const int address ) {
+				return Cell( this, address );
+			}
+
 			inline Cell  cell( const Cell::Index& i ) {
-				return Cell( this, i );
+				return Cell( this, i.address() );
 			}
 
 			inline Cell  cell( const int x, const int y, const int v ) {
@@ -184,67 +264,184 @@ namespace sudoku
 
 			Area::Index  IndexOfContainingArea( const Area::Type &t, const Cell::Index &i ) const;
 
+			inline Area::Index  IndexOfArea( const int address ) const {
+				return Area::Index( (Area::Type) (address / 81), (address / 9) % 9, address % 9 );
+			}
+
 			void  convertToTable( Table &t ) const;
 
 		private:
-			int  _cells[9*9*9];
-			int  _potentials[4*9*9];
-			int  _possible_value[4*9*9];
-			bool  _using_weak_value[4*9*9];
-		};
-
-		class Snapshot
-		{
-		public:
-			class AreaRef
+			//NOTE: Layout tables
+			// The addresses of the 4 areas containing a cell (by Area::Type),
+			// and of the 9 cells of an area (in the order of IndexOfCell()),
+			// computed once, so the hot paths need no switch or division.
+			struct Layout
 			{
-			public:
-				inline AreaRef( Solver *o, const Cube::Area::Index &i ) : _owner(o), _index(i)  {}
+				int16_t  areas[9*9*9][4];
+				int16_t  cells[4*9*9][9];
 
-				inline Cube::Area::Index  index() const {
-					return _index;
-				}
+				static const Layout  instance;
 
-				inline Cube::Area  get() const {
-					return _owner->_current_snapshot->cube.area(_index);
-				}
+				Layout();
+			};
+
+			Slot  _cells[9*9*9];
+			Slot  _potentials[4*9*9];
+			Slot  _possible_value[4*9*9];
+			Slot  _using_weak_value[4*9*9];
+			Slot  _completed[4*9*9];
+			Trail  *_trail;
+
+			//NOTE: Bucket queue
+			// The incomplete areas are chained into doubly linked lists, one per
+			// potential (0..90). The bits of _nonempty_buckets tell which lists
+			// have members, so the most constrained area is found in O(1).
+			//
+			// An area is linked at the head of its list and the head is taken,
+			// so of the areas of the lowest potential the one changed last is
+			// decided: at first the highest address, later an area next to the
+			// latest placement. Unwinding links the areas back at the head too,
+			// so after a backstep the areas of the undone decision come first.
+			// This order keeps the search near its last moves, on
+			// samples/test.set it takes 19 decisions and 5 backsteps in total,
+			// against 55 and 22 of the pool sorted by potential only.
+			enum {
+				MAX_POTENTIAL = 9 * 10,
+			};
 
-				inline bool  operator< ( const AreaRef &o ) const {
-					return this->get().potential() < o.get().potential();
+			int16_t  _next_area[4*9*9];
+			int16_t  _prev_area[4*9*9];
+			int16_t  _bucket[MAX_POTENTIAL+1];
+			uint64_t  _nonempty_buckets[2];
+
+			void  link( const int area );
+			void  unlink( const int area );
+
+			inline void  assign( Slot &slot, const int value, const int area = -1 )
+			{
+				if( _trail != 0 )
+				{
+					Change  c = { &slot, (int16_t) area, slot };
+					_trail->push_back(c);
 				}
+				slot = value;
+			}
 
-			private:
-				Solver *_owner;
-				Cube::Area::Index  _index;
-			};
+			void  markOccupied( const int cell );
+			void  markUnobtainable( const int cell );
+			void  adjustPotentials( const int cell, const int delta );
+			void  complete( const int area );
+		};
 
-			typedef std::deque<AreaRef>  AreaPool;
-			typedef std::list<Cube::Cell::Index>  History;
+		// Where the trail stood when a decision was made, the alternatives
+		// of a shared decision are left to the one which took them
+		struct Mark
+		{
+			Cube::Area::Index  area;
+			size_t  trail;
+			bool  shared;
+
+			inline Mark( const Cube::Area::Index &a, const size_t t, const bool s ) : area(a), trail(t), shared(s)  {}
+		};
 
+	public:
+		struct Branch
+		{
 			Cube  cube;
-			AreaPool  remaining_areas;
-			History  history;
+			Cube::Area::Index  area;
 
-			inline Snapshot() {}
-			inline Snapshot( const Snapshot &o ) : cube(o.cube), remaining_areas(o.remaining_areas), history()  {}
+			//NOTE: the copy does not record its changes, the trail is the owner's
+			inline Branch( const Cube &c, const Cube::Area::Index &a ) : cube(c), area(a) {
+				cube.record(0);
+			}
 		};
 
+	private:
+
+
+		//NOTE: Working memory
+		// The trail and the marks are reserved for the deepest search once,
+		// and keep their capacity over init(), so a solve does not allocate
+		// after the first one. A decision occupies a cell, so there are at
+		// most 81 marks. Along the trail a cell changes at most twice (FREE,
+		// WEAK_UNOBTAINABLE, then UNOBTAINABLE or OCCUPIED), each change but
+		// the occupation moves the potentials of its 4 areas, and an area is
+		// completed once and steps its candidate index at most 21 times.
+		enum {
+			MAX_MARKS = 9 * 9,
+			MAX_TRAIL = 9 * 9 * 9 * (2 + 2 * 4) + 4 * 9 * 9 * (1 + 21),
+		};
 
-		Snapshot  *_current_snapshot;
-		std::stack<Snapshot*>  _snapshots;
+		Cube  _cube;
+		Cube::Trail  _trail;
+		std::vector<Mark>  _marks;
+		Sharing  *_sharing;
+		unsigned  _rules;
 
 		// statistical info
 		int  _decisions;
 		int  _backsteps;
+		int  _eliminations[RULES];
 
-		void  takeSnapshot();
-		void  restoreLastSnapshot();
+		void  undoLastDecision();
 
-		bool  deterministicMove()  DEBUG_THROWING;
+		bool  deterministicMove();
+
+		// Candidates of the cells as digit masks, [y][x]
+		typedef uint16_t  Candidates[9][9];
+
+		void  readCandidates( Candidates &c );
+
+		// Apply a rule once, and return the number of eliminated candidates
+		int  lockedCandidates( Candidates &c );
+		int  nakedSubsets( Candidates &c, const int size );
+		int  hiddenSubsets( Candidates &c, const int size );
+		int  xWing( Candidates &c );
+
+		// Applies the first enabled rule which eliminates anything
+		bool  applyRules();
+
+		bool  search( Cube::Area::Index area );
 
 	public:	
-		void  init( const Table& t )  DEBUG_THROWING;
-		bool  run()  DEBUG_THROWING;
+		inline Solver() : _sharing(0), _rules(0), _decisions(0), _backsteps(0)  {
+			for( int r = 0; r != RULES; ++r )
+				_eliminations[r] = 0;
+		}
+
+		inline void  enable( const Rule r, const bool on = true )
+		{
+			if( on )
+				_rules |= 1u << r;
+			else
+				_rules &= ~(1u << r);
+		}
+
+		inline bool  enabled( const Rule r ) const {
+			return _rules & (1u << r);
+		}
+
+		static const char*  ruleName( const Rule r );
+
+		void  init( const Table& t );
+
+		// Rules out a value of a cell, between init() and run()
+		void  exclude( const int x, const int y, const Value v );
+
+		bool  run();
+
+		// Searches a branch given away by another solver, the statistics are
+		// added to the ones since the last init()
+		bool  explore( const Branch &b );
+
+		// The open decisions are offered to s while searching (0 to stop)
+		inline void  share( Sharing *s ) {
+			_sharing = s;
+		}
+
+		// Continues the search after the solution found by run() or the
+		// previous next(), returns false when there are no more solutions
+		bool  next();
 
 		void  extractTable( Table& t ) const;
 
@@ -255,6 +452,11 @@ namespace sudoku
 		inline int  backsteps() const {
 			return _backsteps;
 		}
+
+		// Candidates the rule eliminated since init()
+		inline int  eliminations( const Rule r ) const {
+			return _eliminations[r];
+		}
     };
 }
 #endif
@@ -1,73 +1,107 @@
 #include "table.h"
+#include <cctype>
+#include <iomanip>
 
 
 namespace sudoku {
 
-Table::State  Table::check() const
+namespace {
+
+// Value of the characters of the one-line format, INVALID for the others
+struct LineCharacters
 {
-	const int check_s = 1+2+3+4+5+6+7+8+9;
-	const int check_p = 1*2*3*4*5*6*7*8*9;
+	enum {
+		INVALID = 0xFF,
+	};
 
-	for( int y = 0; y != 9; ++y )
-	{
-		int s = 0, p = 1;
-		for( int x = 0; x != 9; ++x )
-			s += operator()(x,y), p *= operator()(x,y);
+	unsigned char  value[256];
 
-		if( p == 0 )
-			return INCOMPLETE;
-		if( s != check_s || p != check_p )
-			return INVALID;
+	LineCharacters()
+	{
+		for( int c = 0; c != 256; ++c )
+			value[c] = INVALID;
+
+		value['.'] = 0;
+		for( int d = 0; d != 10; ++d )
+			value['0' + d] = d;
+		for( int l = 0; l != 26; ++l )
+			value['A' + l] = value['a' + l] = 10 + l;
 	}
+};
 
-	for( int x = 0; x != 9; ++x )
-	{
-		int s = 0, p = 1;
-		for( int y = 0; y != 9; ++y )
-			s += operator()(x,y), p *= operator()(x,y);
+const LineCharacters  line_characters;
 
-		if( p == 0 )
-			return INCOMPLETE;
-		if( s != check_s || p != check_p )
-			return INVALID;
-	}
+inline char  lineCharacter( const int v )
+{
+	return v <= 0 ? '.' : v < 10 ? '0' + v : 'A' + v - 10;
+}
 
-	for( int j = 0; j != 3; ++j )
-		for( int i = 0; i != 3; ++i )
+// Width of the largest value in the text formats
+inline int  valueWidth( const int size )
+{
+	return size < 10 ? 1 : 2;
+}
+
+}
+
+
+template< int BOX >
+typename BasicTable<BOX>::State  BasicTable<BOX>::check() const
+{
+	const int  SIZE = BOX * BOX;
+	const unsigned long  all = (1ul << SIZE) - 1;
+
+	// Values seen in the houses: rows, then columns, then boxes
+	unsigned long  seen[3 * SIZE] = {};
+	bool  incomplete[3 * SIZE] = {};
+	for( int y = 0; y != SIZE; ++y )
+		for( int x = 0; x != SIZE; ++x )
 		{
-			int s = 0, p = 1;
-			for( int y = j*3; y != (j+1)*3; ++y )
-				for( int x = i*3; x != (i+1)*3; ++x )
-					s += operator()(x,y), p *= operator()(x,y);
-
-			if( p == 0 )
-				return INCOMPLETE;
-			if( s != check_s || p != check_p )
-				return INVALID;
+			const int  v = (*this)(x,y);
+			const int  b = 2 * SIZE + (y / BOX) * BOX + x / BOX;
+			//NOTE: a value out of range spoils the masks of its houses
+			const unsigned long  bit = (v >= 1 && v <= SIZE) ? 1ul << (v - 1) : ~0ul;
+
+			seen[y] |= bit, seen[SIZE + x] |= bit, seen[b] |= bit;
+			if( v == empty )
+				incomplete[y] = incomplete[SIZE + x] = incomplete[b] = true;
 		}
 
+	//NOTE: the first incomplete or invalid house decides, in the order above
+	for( int h = 0; h != 3 * SIZE; ++h )
+	{
+		if( incomplete[h] )
+			return INCOMPLETE;
+		if( seen[h] != all )
+			return INVALID;
+	}
+
 	return CORRECT;
 }
 
 
-std::istream&  operator>> ( std::istream& is, Table& t )
+template< int BOX >
+std::istream&  operator>> ( std::istream& is, BasicTable<BOX>& t )
 {
-	for( int y = 0; y != 9; ++y )
-		for( int x = 0; x != 9; ++x )
+	for( int y = 0; y != BOX * BOX; ++y )
+		for( int x = 0; x != BOX * BOX; ++x )
 			is >> t(x,y);
 	
 	return is;
 }
 
-std::ostream&  operator<< ( std::ostream& os, const Table& t )
+template< int BOX >
+std::ostream&  operator<< ( std::ostream& os, const BasicTable<BOX>& t )
 {
-	for( int y = 0; y != 9; ++y ) 
+	const int  width = valueWidth( BOX * BOX );
+	for( int y = 0; y != BOX * BOX; ++y ) 
 	{
-		for( int x = 0; x != 9; ++x )
+		for( int x = 0; x != BOX * BOX; ++x )
 		{
 			if( x != 0 ) os << " ";
 
-			if( t(x,y) > Table::empty ) os << t(x,y);
+			os << std::setw(width);
+			if( t(x,y) > BasicTable<BOX>::empty ) os << t(x,y);
 				else os << ".";
 		}
 
@@ -78,25 +112,77 @@ std::ostream&  operator<< ( std::ostream& os, const Table& t )
 }
 
 
-std::ostream&  operator<< ( std::ostream &os, const FormatedTable &t )
+template< int BOX >
+std::ostream&  operator<< ( std::ostream &os, const BasicFormatedTable<BOX> &t )
 {
-	for( int y = 0; y != 9; ++y ) 
+	const int  width = valueWidth( BOX * BOX );
+	for( int y = 0; y != BOX * BOX; ++y ) 
 	{
-		for( int x = 0; x != 9; ++x )
+		for( int x = 0; x != BOX * BOX; ++x )
 		{
 			if( x != 0 )
-				if( x % 3 == 0 ) os << "   ";
+				if( x % BOX == 0 ) os << "   ";
 					else os << " ";
 
-			if( t()(x,y) > Table::empty ) os << t()(x,y);
+			os << std::setw(width);
+			if( t()(x,y) > BasicTable<BOX>::empty ) os << t()(x,y);
 				else os << ".";
 		}
 
-		if( y % 3 == 2 && y != 8 ) os << std::endl << std::endl;
+		if( y % BOX == BOX - 1 && y != BOX * BOX - 1 ) os << std::endl << std::endl;
 			else os << std::endl;
 	}
 
 	return os;
 }
 
+
+template< int BOX >
+bool  readLine( const char *line, const size_t length, BasicTable<BOX> &t )
+{
+	const int  SIZE = BOX * BOX;
+	const size_t  cells = SIZE * SIZE;
+	if( length < cells || (length > cells && !isspace(line[cells])) )
+		return false;
+
+	//NOTE: digits and dots follow each other randomly, so the loop is kept
+	// free of branches on them
+	bool  malformed = false;
+	for( int y = 0; y != SIZE; ++y )
+		for( int x = 0; x != SIZE; ++x, ++line )
+		{
+			const int  v = line_characters.value[ (unsigned char) *line ];
+
+			malformed |= v > SIZE;
+			t(x,y) = v;
+		}
+
+	return !malformed;
+}
+
+template< int BOX >
+std::ostream&  operator<< ( std::ostream &os, const BasicLineTable<BOX> &t )
+{
+	const int  SIZE = BOX * BOX;
+	char  line[SIZE * SIZE];
+	for( int i = 0; i != SIZE * SIZE; ++i )
+		line[i] = lineCharacter( t()(i % SIZE, i / SIZE) );
+
+	return os.write( line, SIZE * SIZE );
+}
+
+
+#define SUDOKU_INSTANTIATE_TABLE(BOX) \
+	template class BasicTable<BOX>; \
+	template std::istream&  operator>> ( std::istream& is, BasicTable<BOX>& t ); \
+	template std::ostream&  operator<< ( std::ostream& os, const BasicTable<BOX>& t ); \
+	template std::ostream&  operator<< ( std::ostream &os, const BasicFormatedTable<BOX> &t ); \
+	template bool  readLine( const char *line, const size_t length, BasicTable<BOX> &t ); \
+	template std::ostream&  operator<< ( std::ostream &os, const BasicLineTable<BOX> &t );
+
+SUDOKU_INSTANTIATE_TABLE(2)
+SUDOKU_INSTANTIATE_TABLE(3)
+SUDOKU_INSTANTIATE_TABLE(4)
+SUDOKU_INSTANTIATE_TABLE(5)
+
 }
@@ -8,11 +8,18 @@
 
 namespace sudoku
 {
-	class Table : public FixMatrix<short int, 9>
+	//NOTE: Table sizes
+	// A table of box size BOX has BOX*BOX rows, columns and boxes, and holds
+	// the values 1..BOX*BOX. The members are instantiated in table.cc for the
+	// box sizes 2, 3, 4 and 5 (4x4 to 25x25 tables); Table is the classic 9x9.
+	template< int BOX >
+	class BasicTable : public FixMatrix<short int, BOX*BOX>
 	{
 	public:
 		// Public types and constants
-		typedef FixMatrix<short int, 9>  Parent;
+		typedef FixMatrix<short int, BOX*BOX>  Parent;
+
+		static const int Box = BOX;
 
 		enum {
 			empty = 0,
@@ -27,35 +34,70 @@ namespace sudoku
 
 
 		// Constructors
-		inline Table()
+		inline BasicTable()
 		{
-			reset();
+			Parent::reset();
 		}
 
 		template< typename IT >
-		inline Table( const IT& begin, const IT& end ) : Parent(begin,end)
+		inline BasicTable( const IT& begin, const IT& end ) : Parent(begin,end)
 		{}
 
 		// Sudoku table handling
 		State  check() const;
 	};
 
-	std::istream&  operator>> ( std::istream& is, Table& t );
-	std::ostream&  operator<< ( std::ostream& os, const Table& t );
+	typedef BasicTable<3>  Table;
+
+	template< int BOX >
+	std::istream&  operator>> ( std::istream& is, BasicTable<BOX>& t );
+	template< int BOX >
+	std::ostream&  operator<< ( std::ostream& os, const BasicTable<BOX>& t );
 
 
-	class FormatedTable
+	template< int BOX >
+	class BasicFormatedTable
 	{
 	public:
-		inline explicit  FormatedTable( const Table &t ) : _table(t)  {}
-		inline const Table&  operator() () const {
+		inline explicit  BasicFormatedTable( const BasicTable<BOX> &t ) : _table(t)  {}
+		inline const BasicTable<BOX>&  operator() () const {
 			return _table;
 		}
 
 	private:
-		const Table  &_table;
+		const BasicTable<BOX>  &_table;
 	};
 
-	std::ostream&  operator<< ( std::ostream &os, const FormatedTable &t );
+	typedef BasicFormatedTable<3>  FormatedTable;
+
+	template< int BOX >
+	std::ostream&  operator<< ( std::ostream &os, const BasicFormatedTable<BOX> &t );
+
+
+	//NOTE: One-line format
+	// The cells row by row, one character each, with '0' or '.' for the empty
+	// cells. The values above 9 are letters: 'A' (or 'a') is 10, 'B' is 11 and
+	// so on. Anything after the last cell must be separated by whitespace.
+	template< int BOX >
+	bool  readLine( const char *line, const size_t length, BasicTable<BOX> &t );
+
+	template< int BOX >
+	class BasicLineTable
+	{
+	public:
+		inline explicit  BasicLineTable( const BasicTable<BOX> &t ) : _table(t)  {}
+		inline const BasicTable<BOX>&  operator() () const {
+			return _table;
+		}
+
+	private:
+		const BasicTable<BOX>  &_table;
+	};
+
+	typedef BasicLineTable<3>  LineTable;
+
+	// Writes one character per cell, without a line break
+	template< int BOX >
+	std::ostream&  operator<< ( std::ostream &os, const BasicLineTable<BOX> &t );
 }
 #endif
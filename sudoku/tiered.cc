@@ -0,0 +1,173 @@
+#include "tiered.h"
+#include "bits/geometry.h"
+
+
+namespace sudoku {
+
+namespace {
+
+// The cells of the houses, rows, columns, then boxes, as y * 9 + x
+inline int  cellOf( const int house, const int i )
+{
+	return BitGeometry<3>::instance.cells_of_house[house][i];
+}
+
+inline int  digitOf( const uint16_t single )
+{
+	return __builtin_ctz(single) + 1;
+}
+
+}
+
+
+TieredSolver::TieredSolver() : _free(0), _consistent(false), _tier(SINGLES), _backsteps(0)
+{
+	for( int h = 0; h != 27; ++h )
+		_houses[h] = 0;
+}
+
+void  TieredSolver::place( const int cell, const int digit )
+{
+	const int  x = cell % 9, y = cell / 9;
+	const Mask  bit = 1 << (digit - 1);
+
+	_table(x,y) = digit;
+	_houses[y] |= bit;
+	_houses[9 + x] |= bit;
+	_houses[18 + (y / 3) * 3 + x / 3] |= bit;
+	--_free;
+}
+
+void  TieredSolver::init( const Table& t )
+{
+	_table.reset( Table::empty );
+	for( int h = 0; h != 27; ++h )
+		_houses[h] = 0;
+	_free = 81;
+	_consistent = true;
+	_tier = SINGLES;
+	_backsteps = 0;
+
+	for( int y = 0; y != 9; ++y )
+		for( int x = 0; x != 9; ++x )
+		{
+			const Table::Value  v = t(x,y);
+			if( v == Table::empty )
+				continue;
+
+			//NOTE: a given repeated in a house makes the table unsolvable
+			if( v < 1 || v > 9 || !(candidates( y * 9 + x ) & (1 << (v - 1))) )
+				_consistent = false;
+			else
+				place( y * 9 + x, v );
+		}
+}
+
+bool  TieredSolver::nakedSingles( bool &progress )
+{
+	for( int cell = 0; cell != 81; ++cell )
+	{
+		if( _table( cell % 9, cell / 9 ) != Table::empty )
+			continue;
+
+		const Mask  m = candidates(cell);
+		if( m == 0 )
+			return false;
+
+		if( !(m & (m - 1)) )
+		{
+			place( cell, digitOf(m) );
+			progress = true;
+		}
+	}
+
+	return true;
+}
+
+bool  TieredSolver::hiddenSingles( bool &progress )
+{
+	for( int h = 0; h != 27; ++h )
+	{
+		// The digits possible in one cell of the house, and in more
+		Mask  once = 0, twice = 0;
+		for( int i = 0; i != 9; ++i )
+		{
+			const int  cell = cellOf( h, i );
+			if( _table( cell % 9, cell / 9 ) != Table::empty )
+				continue;
+
+			const Mask  m = candidates(cell);
+			twice |= once & m;
+			once |= m;
+		}
+
+		if( (once | _houses[h]) != 0x1FF )
+			return false;
+
+		//NOTE: a placement may take the digits of the others, so they are
+		// checked again against the cell
+		for( Mask singles = once & ~twice & ~_houses[h]; singles; singles &= singles - 1 )
+		{
+			const Mask  bit = singles & -singles;
+			for( int i = 0; i != 9; ++i )
+			{
+				const int  cell = cellOf( h, i );
+				if( _table( cell % 9, cell / 9 ) == Table::empty && (candidates(cell) & bit) )
+				{
+					place( cell, digitOf(bit) );
+					progress = true;
+					break;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool  TieredSolver::run()
+{
+	_tier = SINGLES;
+	if( !_consistent )
+		return false;
+
+	bool  progress = true;
+	while( progress && _free != 0 )
+	{
+		progress = false;
+		if( !nakedSingles(progress) )
+			return false;
+
+		//NOTE: the naked singles are cheaper, the hidden ones are looked for
+		// only when they are exhausted
+		if( !progress && !hiddenSingles(progress) )
+			return false;
+	}
+
+	if( _free == 0 )
+		return true;
+
+	_tier = SEARCH;
+	_solver.init(_table);
+	return _solver.run();
+}
+
+bool  TieredSolver::next()
+{
+	if( _tier == SEARCH )
+		return _solver.next();
+
+	//NOTE: the solution of the singles is the only one
+	++_backsteps;
+	return false;
+}
+
+void  TieredSolver::extractTable( Table& t ) const
+{
+	if( _tier == SEARCH )
+		_solver.extractTable(t);
+	else
+		t = _table;
+}
+
+}
@@ -0,0 +1,84 @@
+#ifndef SUDOKU_TIERED_H
+#define SUDOKU_TIERED_H
+
+#include "table.h"
+#include "solver.h"
+#include <stdint.h>
+
+
+
+namespace sudoku
+{
+	//NOTE: Tiered solving
+	// Most tables are finished by the singles alone, so the first tier runs
+	// the naked and hidden singles to a fixpoint on digit masks taken from
+	// the table, without building a Cube. Only a table where they get stuck
+	// goes to the second tier, a Solver started from the cells the singles
+	// filled in. The deductions of the singles are forced, so a table they
+	// complete has no other solution.
+	class TieredSolver
+	{
+	public:
+		typedef Table  TableType;
+
+		enum Tier {
+			SINGLES,
+			SEARCH,
+			TIERS,
+		};
+
+		TieredSolver();
+
+		// The solver of the second tier, e.g. to enable its rules
+		inline Solver&  search() {
+			return _solver;
+		}
+
+		void  init( const Table& t );
+
+		bool  run();
+
+		// Continues the search after the solution found by run() or the
+		// previous next(), returns false when there are no more solutions
+		bool  next();
+
+		void  extractTable( Table& t ) const;
+
+		// The tier which finished the last run(), solved or not
+		inline Tier  tier() const {
+			return _tier;
+		}
+
+		inline int  decisions() const {
+			return _tier == SEARCH ? _solver.decisions() : 0;
+		}
+
+		inline int  backsteps() const {
+			return _tier == SEARCH ? _solver.backsteps() + _backsteps : _backsteps;
+		}
+
+	private:
+		typedef uint16_t  Mask;
+
+		Table  _table;
+		Mask  _houses[27]; // placed digits: rows, then columns, then boxes
+		int  _free;
+		bool  _consistent;
+		Tier  _tier;
+		int  _backsteps; // of next() after the first tier
+
+		void  place( const int cell, const int digit );
+
+		inline Mask  candidates( const int cell ) const {
+			const int  x = cell % 9, y = cell / 9;
+			return ~(_houses[y] | _houses[9 + x] | _houses[18 + (y / 3) * 3 + x / 3]) & 0x1FF;
+		}
+
+		// The singles to a fixpoint, returns false on a contradiction
+		bool  nakedSingles( bool &progress );
+		bool  hiddenSingles( bool &progress );
+
+		Solver  _solver;
+	};
+}
+#endif
@@ -0,0 +1,117 @@
+#include "workpool.h"
+
+
+namespace sudoku {
+
+WorkPool::WorkPool( const int workers ) : _ranges( workers < 1 ? 1 : workers ), _job(0)
+{
+	for( size_t i = 0; i != _ranges.size(); ++i )
+	{
+		_ranges[i].begin = _ranges[i].end = 0;
+		pthread_mutex_init( &_ranges[i].lock, 0 );
+	}
+}
+
+WorkPool::~WorkPool()
+{
+	for( size_t i = 0; i != _ranges.size(); ++i )
+		pthread_mutex_destroy( &_ranges[i].lock );
+}
+
+bool  WorkPool::take( const int worker, long &item )
+{
+	Range  &own = _ranges[worker];
+
+	pthread_mutex_lock( &own.lock );
+	const bool  found = own.begin != own.end;
+	if( found )
+		item = own.begin++;
+	pthread_mutex_unlock( &own.lock );
+
+	return found;
+}
+
+bool  WorkPool::steal( const int worker )
+{
+	const int  n = workers();
+	for( int i = 1; i != n; ++i )
+	{
+		Range  &victim = _ranges[ (worker + i) % n ];
+
+		pthread_mutex_lock( &victim.lock );
+		const long  begin = victim.begin + (victim.end - victim.begin) / 2;
+		const long  end = victim.end;
+		victim.end = begin;
+		pthread_mutex_unlock( &victim.lock );
+
+		if( begin != end )
+		{
+			Range  &own = _ranges[worker];
+
+			pthread_mutex_lock( &own.lock );
+			own.begin = begin;
+			own.end = end;
+			pthread_mutex_unlock( &own.lock );
+
+			return true;
+		}
+	}
+
+	//NOTE: the items are never added while running, so no work is left
+	return false;
+}
+
+void  WorkPool::work( const int worker )
+{
+	_job->enter(worker);
+
+	long  item;
+	do
+		while( take( worker, item ) )
+			_job->process( worker, item );
+	while( steal(worker) );
+
+	_job->leave(worker);
+}
+
+void*  WorkPool::start( void *worker )
+{
+	Worker  *w = (Worker*) worker;
+	w->pool->work( w->index );
+	return 0;
+}
+
+void  WorkPool::run( Job &job, const long count )
+{
+	const int  n = workers();
+
+	_job = &job;
+	for( int i = 0; i != n; ++i )
+	{
+		_ranges[i].begin = count * i / n;
+		_ranges[i].end = count * (i + 1) / n;
+	}
+
+	//NOTE: The calling thread is the first worker. A worker whose thread
+	// fails to start takes no items, its range is stolen by the others, so
+	// the job is still done, by the calling thread alone if need be.
+	std::vector<pthread_t>  threads( n );
+	std::vector<Worker>  workers( n );
+	std::vector<char>  started( n, 0 );
+	for( int i = 1; i != n; ++i )
+	{
+		workers[i].pool = this;
+		workers[i].index = i;
+		started[i] = pthread_create( &threads[i], 0, start, &workers[i] ) == 0;
+	}
+
+	work(0);
+
+	for( int i = 1; i != n; ++i )
+		if( started[i] )
+			pthread_join( threads[i], 0 );
+
+	_job = 0;
+}
+
+}
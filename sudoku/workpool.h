@@ -0,0 +1,69 @@
+#ifndef SUDOKU_WORKPOOL_H
+#define SUDOKU_WORKPOOL_H
+
+#include <pthread.h>
+#include <vector>
+
+
+
+namespace sudoku
+{
+	//NOTE: Work-stealing pool
+	// The items of a job are split into one contiguous range per worker.
+	// A worker takes items from the front of its own range, and when that
+	// runs dry it steals the back half of another worker's range. So the
+	// cost of the items need not be uniform to keep every worker busy.
+	class WorkPool
+	{
+	public:
+		class Job
+		{
+		public:
+			virtual ~Job()  {}
+
+			// Called once for every item, from the thread of the given worker
+			virtual void  process( const int worker, const long item ) = 0;
+
+			// Called from the thread of the worker before it takes its first
+			// item of a run, and after its last one
+			virtual void  enter( const int )  {}
+			virtual void  leave( const int )  {}
+		};
+
+		explicit WorkPool( const int workers );
+		~WorkPool();
+
+		inline int  workers() const {
+			return (int) _ranges.size();
+		}
+
+		// Processes the items [0, count) of the job, returns when all are done
+		void  run( Job &job, const long count );
+
+	private:
+		struct Range
+		{
+			long  begin, end;
+			pthread_mutex_t  lock;
+		};
+
+		struct Worker
+		{
+			WorkPool  *pool;
+			int  index;
+		};
+
+		std::vector<Range>  _ranges;
+		Job  *_job;
+
+		bool  take( const int worker, long &item );
+		bool  steal( const int worker );
+		void  work( const int worker );
+
+		static void*  start( void *worker );
+
+		WorkPool( const WorkPool& );
+		WorkPool&  operator= ( const WorkPool& );
+	};
+}
+#endif